@@ -0,0 +1,104 @@
+/**********************************************************************
+ * avr_tuner - automatic string selection
+ * License: GPLv3+ (See LICENSE)
+ *
+ * With AUTO_NOTE the string played is found instead of picked with the
+ * button. A scan frame is captured at the rate of notes[NOTE_SCAN],
+ * 1500 Hz after the decimator, which puts every string's fundamental
+ * and octave (82 .. 659 Hz) into the analysed band at about 12 Hz a
+ * bar. auto_pick() scores each string by the strongest bar around
+ * both and takes the best; the following frames are captured at that
+ * string's own rate exactly as if it had been selected by hand.
+ *
+ * auto_rescan() goes back to scanning only when the readings stop
+ * fitting the string: none for AUTO_LOST frames, one more than 1.5
+ * semitones off (another string folded into the band), or more level
+ * two octaves down than on the note (E2 heard through its 4th
+ * harmonic while E is selected; not with SPECTRUM_GOERTZEL, which
+ * doesn't compute that bar).
+ **********************************************************************/
+
+/* Frames in a row without a reading before scanning again */
+#define AUTO_LOST	4
+
+/* A string's score has to beat the mean bar of the band this many
+ * times; noise makes 4 at most, a plucked string 11 and more */
+#define AUTO_SNR	6
+
+/* auto_next while the string stays */
+#define AUTO_STAY	0xFF
+
+/* Auto mode selected; the string found last; where to capture after
+ * the current frame */
+static uint8_t note_auto;
+static uint8_t auto_note = AUTO_STAY, auto_next = AUTO_STAY;
+static uint8_t auto_missed;
+
+/* Strongest bar next to bar */
+static inline uint16_t auto_level(const uint16_t bar)
+{
+	uint16_t s = spectrum[bar - 1];
+
+	if (spectrum[bar] > s)
+		s = spectrum[bar];
+	if (spectrum[bar + 1] > s)
+		s = spectrum[bar + 1];
+	return s;
+}
+
+/* Bar of harmonic h of a string in a scan frame, rounded */
+static inline uint16_t auto_bar(const uint8_t note, const uint8_t h)
+{
+	const uint32_t scan = notes[NOTE_SCAN].freq;
+
+	return num_quot((uint32_t)notes[note].freq * NOTE_BAR * h * 2 + scan,
+			scan * 2, 10);
+}
+
+/* String of a scan frame, AUTO_STAY if none stands out */
+static inline uint8_t auto_pick(void)
+{
+	uint32_t score, best_score = 0, sum = 0;
+	uint8_t note, best = AUTO_STAY;
+	uint16_t i;
+
+	for (i = SPECTRUM_FIRST; i < SPECTRUM_FIRST + SPECTRUM_COUNT; i++)
+		sum += spectrum[i];
+
+	for (note = NOTE_E2; note <= NOTE_E; note++) {
+		score = (uint32_t)auto_level(auto_bar(note, 1)) +
+			auto_level(auto_bar(note, 2));
+		if (score > best_score) {
+			best_score = score;
+			best = note;
+		}
+	}
+	if (best_score * SPECTRUM_COUNT < AUTO_SNR * sum)
+		best = AUTO_STAY;
+	printf("AUTO %d\n", best);
+	return best;
+}
+
+/* After the analysis of a string's frame: 1 to scan again */
+static inline uint8_t auto_rescan(void)
+{
+	const num_t note = notes[current_note].freq;
+	/* 1.5 semitones are 9 % */
+	const num_t off = (note >> 4) + (note >> 5);
+
+	if (!frequency_valid)
+		return ++auto_missed >= AUTO_LOST;
+	auto_missed = 0;
+
+	if (v(avg_freq) > note + off || v(avg_freq) < note - off)
+		return 1;
+
+#ifdef SPECTRUM_GOERTZEL
+	/* Bar NOTE_BAR/4 isn't computed */
+	return 0;
+#else
+	/* Two octaves down is below spectrum_min, out of the analysis */
+	return NOTE_BAR / 4 - 1 >= SPECTRUM_FIRST &&
+		auto_level(NOTE_BAR / 4) > auto_level(NOTE_BAR);
+#endif
+}
@@ -0,0 +1,85 @@
+/***********************************
+ * (C) 2010 by Tomasz bla Fortuna <bla@thera.be>.
+ * License: GPL3+ (See LICENSE)
+ *
+ * ATmega32 board: ADC sample source, PB2 button and IR LED on PA1.
+ ********************/
+
+/* Sample handler in Main.c, gets ADC - 0..1023 */
+static void adc_sample(const int16_t adc);
+
+void button_init(void)
+{
+	DDRB &= ~(1<<PB2);
+	PORTB |= (1<<PB2);
+}
+
+char button_clicked(void)
+{
+	return !(PINB & (1<<PB2));
+}
+
+/* IR LED on PA1 */
+static inline void ir_init(void)
+{
+	PORTA |= (1<<PA1);
+	DDRA |= (1<<PA1);
+}
+
+static inline void ir_on(void)
+{
+	PORTA &= ~(1<<PA1);
+}
+
+static inline void ir_off(void)
+{
+	PORTA |= (1<<PA1);
+}
+
+
+/* Conversion every ocr+1 CPU cycles: Timer1 in CTC mode, TOP = OCR1A.
+ * Call with interrupts disabled (16 bit registers). */
+static inline void adc_rate(const uint16_t ocr)
+{
+	OCR1A = ocr;
+	TCNT1 = 0;
+}
+
+static inline void adc_init(void)
+{
+	DDRA = 0x00;
+	PORTA = 0x00;
+
+	ADMUX = 0 | (1<<REFS0);
+//	ADMUX = 3 | (1<<REFS0);
+
+	/* Timer1, no prescaler, CTC; compare match B at 0 triggers the ADC */
+	OCR1B = 0;
+	adc_rate(ADC_OCR(ADC_HZ));
+	TCCR1A = 0;
+	TCCR1B = (1<<WGM12) | (1<<CS10);
+
+	/* Auto trigger source 101: Timer1 compare match B */
+	SFIOR = (SFIOR & 0x1F) | (1<<ADTS2) | (1<<ADTS0);
+
+	/* Prescaler = / 128; 16*10^6 / 128 = 125000 */
+	/* 13.5 cycles per triggered conversion -> at most ~9.2 kHz */
+	ADCSRA = (1<<ADPS2) | (1<<ADPS1) | (1<<ADPS0) | (1<<ADIE) | (1<<ADATE);
+
+	/*
+	 * 000  /2    001  /2
+	 * 010  /4    011  /8
+	 * 100  /16   101  /32
+	 * 110  /64   111  /128
+	 */
+	ADCSRA |= (1<<ADEN);
+}
+
+/* Every conversion goes into the sample handler */
+ISR(ADC_vect)
+{
+	PROF_ISR_BEGIN();
+	TIFR = (1<<OCF1B);
+	adc_sample(ADC);
+	PROF_ISR_END();
+}
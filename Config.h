@@ -0,0 +1,80 @@
+/**********************************************************************
+ * avr_tuner - build options
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Comment out to disable, or override with -D in the Makefile.
+ **********************************************************************/
+
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+/* Samples per frame: FFT_N in FFT/ffft.h (or -DFFT_N, which also
+ * reaches ffft.S). With INPUT_REAL the ATmega32 fits 256 with
+ * CAPTURE_DOUBLE and 512 without; 'make' checks the linked image
+ * against SRAM_BUDGET. */
+
+/* Continuous capture: the ADC interrupt keeps filling a ring of raw
+ * samples while the previous frame is transformed and analysed, so no
+ * samples are lost. Costs 2*FFT_N bytes of SRAM. Without it capture
+ * stops during FFT and analysis, samples are kept inside fft_buff.
+ * Dropped above FFT_N = 256 (Tuner.c). */
+#define CAPTURE_DOUBLE
+
+/* Block floating point: each frame is shifted left by up to this many
+ * bits before the FFT so its peak uses the whole 16 bit range (samples
+ * are 16 x the mean ADC deviation, so 10 lifts a single count to half
+ * scale); spectrum_analyse() moves its noise thresholds along. */
+#define CAPTURE_SHIFT_MAX	10
+
+/* With CAPTURE_DOUBLE the newest FFT_N samples are analysed every
+ * CAPTURE_HOP samples: FFT_N (no overlap), FFT_N/2 (50 %) or FFT_N/4
+ * (75 %). Same resolution, the display follows 1, 2 or 4 times faster
+ * as long as FFT and analysis fit into one hop. */
+#define CAPTURE_HOP	(FFT_N / 2)
+
+/* Compute only the bars within GOERTZEL_SPAN of f/2, f and 3f/2 with
+ * Goertzel filters instead of the full FFT, see Goertzel.c */
+//#define SPECTRUM_GOERTZEL
+#define GOERTZEL_SPAN	4
+
+/* Find the period in the time domain with YIN instead of the FFT and
+ * spectrum_analyse(), see Yin.c */
+//#define PITCH_YIN
+
+/* Pick the fundamental with the old peak collection (up to 4 peaks
+ * fused by their position around NOTE_BAR) instead of the harmonic sum
+ * of spectrum_analyse() */
+//#define ANALYSE_PEAKS
+
+/* Find the string played instead of cycling through them with the
+ * button (which then goes auto, E2 .. E, auto), see Auto.c. Needs the
+ * spectrum and FFT_N >= 128. */
+#define AUTO_NOTE
+
+/* Send every analysed frame (band of the spectrum, harmonics found,
+ * frequency) as a binary frame over the UART, see Telemetry.c */
+//#define TELEMETRY
+
+/* Paint the free SRAM at power-on and stop on error 4 once the stack
+ * has come within STACK_MARGIN bytes of static data, see Stack.c */
+#define STACK_CHECK
+#define STACK_MARGIN	32
+
+/* Time the stages of a frame and the ADC interrupt with Timer1; a
+ * byte sent to the UART dumps the statistics, see Prof.c */
+//#define PROFILE
+
+/* How estimate_bar() places a peak between bars, see Peak.c */
+#define PEAK_CENTROID	1
+#define PEAK_PARABOLIC	2
+#define PEAK_GAUSSIAN	3
+#define PEAK_JAIN	4
+#ifndef PEAK_ESTIMATOR
+#define PEAK_ESTIMATOR	PEAK_JAIN
+#endif
+
+#if defined(PITCH_YIN) || (defined(FFT_N) && FFT_N < 128)
+#undef AUTO_NOTE
+#endif
+
+#endif
@@ -1,14 +1,40 @@
 #ifndef FFT_N
-#define FFT_N	128		/* Number of samples (64,128,256,512). Don't forget to clean! */
+#define FFT_N	128		/* Number of samples (64,128,256,512,1024). Don't forget to clean! */
 #endif
 //#define INPUT_NOUSE
 //#define INPUT_IQ
 
+#ifndef INPUT_REAL	/* Real wave form as FFT_N/2 complex points (0: r = i = sample) */
+#ifdef INPUT_IQ
+#define INPUT_REAL	0
+#else
+#define INPUT_REAL	1
+#endif
+#endif
+
+#if INPUT_REAL && defined(INPUT_IQ)
+#error INPUT_REAL and INPUT_IQ exclude each other.
+#endif
+
+#if INPUT_REAL
+#define FFT_BFLY	(FFT_N / 2)	/* Elements of array_bfly */
+#else
+#define FFT_BFLY	FFT_N
+#endif
+
+#ifndef FFT_TRIVIAL	/* fft_execute() skips the multiplies by W = 1 and W = -j */
+#define FFT_TRIVIAL	1
+#endif
+
 
 
 #ifndef FFFT_ASM	/* for c modules */
 
+#ifdef HOST
+typedef int16_t prog_int16_t;	/* Tables live in plain memory, see ffft.c */
+#else
 #include <avr/pgmspace.h>
+#endif
 typedef struct _tag_complex_t {
 	int16_t	r;
 	int16_t i;
@@ -16,17 +42,20 @@ typedef struct _tag_complex_t {
 
 #ifndef INPUT_NOUSE
   #ifdef INPUT_IQ
-    void fft_input (const complex_t *, complex_t *);
+    void fft_input (const complex_t *, complex_t *, uint8_t);
   #else
-    void fft_input (const int16_t *, complex_t *);
+    void fft_input (const int16_t *, complex_t *, uint8_t);
+    void fft_input_ring (const int16_t *, uint16_t, complex_t *, uint8_t);
   #endif
 #endif
 
-void fft_execute (complex_t *);
+uint8_t fft_execute (complex_t *);	/* Stages left unscaled (block exponent) */
 void fft_output (const complex_t *, uint16_t *);
+void fft_output_band (const complex_t *, uint16_t *, uint16_t, uint16_t);
 int16_t fmuls_f (int16_t, int16_t);
 
 extern const prog_int16_t tbl_window[];
+extern const prog_int16_t tbl_cos_sin[];	/* {cos(x),sin(x)}, 0 <= x < pi, FFT_N/2 steps */
 
 
 
@@ -134,6 +163,18 @@ extern const prog_int16_t tbl_window[];
 	rol	\dh
 .endm
 
+.macro	lsld	d3,d2,d1,d0
+	lsl	\d0
+	rol	\d1
+	rol	\d2
+	rol	\d3
+.endm
+
+.macro	rorw	dh, dl
+	ror	\dh
+	ror	\dl
+.endm
+
 .macro	pushw	dh, dl
 	push	\dh
 	push	\dl
@@ -0,0 +1,61 @@
+#!/usr/bin/python3
+# Generate constant tables of ffft.S / ffft.c for a given FFT_N.
+#
+#   tables.py asm 512 > tbl.S
+#   tables.py c 512 > tbl.c
+#
+# Values are truncated, with the +1.0 peaks written as 32766 (except
+# cos(0)), which reproduces the shipped 64..256 tables up to a few
+# single-LSB rounding differences; those tables are kept as shipped.
+import sys
+from math import cos, sin, pi
+
+
+def fix(x):
+    v = int(32767 * x)
+    return 32766 if v == 32767 else v
+
+
+def window(n):
+    return [fix(0.54 - 0.46 * cos(2 * pi * i / n)) for i in range(n)]
+
+
+def cos_sin(n):
+    t = []
+    for i in range(n // 2):
+        t += [fix(cos(2 * pi * i / n)), fix(sin(2 * pi * i / n))]
+    t[0] = 32767
+    return t
+
+
+def bitrev(n):
+    bits = n.bit_length() - 1
+    return [int(format(i, '0%db' % bits)[::-1], 2) for i in range(n // 2)]
+
+
+def rows(vals, asm):
+    out = []
+    for i in range(0, len(vals), 16):
+        line = ', '.join(vals[i:i + 16])
+        out.append('\t.dc.w\t' + line if asm else '\t' + line + ',')
+    return out
+
+
+def main():
+    asm = sys.argv[1] == 'asm'
+    n = int(sys.argv[2])
+    scale = '*4' if asm else ''
+
+    print('; tbl_window' if asm else '/* tbl_window */')
+    print('\n'.join(rows([str(v) for v in window(n)], asm)))
+    print('; tbl_cos_sin' if asm else '/* tbl_cos_sin */')
+    print('\n'.join(rows([str(v) for v in cos_sin(n)], asm)))
+    print('; tbl_bitrev' if asm else '/* tbl_bitrev */')
+    print('#ifdef INPUT_IQ')
+    print('\n'.join(rows(['%d%s' % (v + 1, scale) for v in bitrev(n)], asm)))
+    print('#endif')
+    print('\n'.join(rows(['%d%s' % (v, scale) for v in bitrev(n)], asm)))
+
+
+if __name__ == '__main__':
+    main()
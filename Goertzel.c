@@ -0,0 +1,96 @@
+/**********************************************************************
+ * avr_tuner - Goertzel spectrum engine
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Selected with SPECTRUM_GOERTZEL in Config.h instead of fft_execute()
+ * and fft_output(). Every note's ADC rate puts its frequency on bar
+ * FFT_N/4, so only the bars within GOERTZEL_SPAN of f/2, f and 3f/2
+ * (FFT_N/8, FFT_N/4 and 3*FFT_N/8) are computed, one Goertzel filter
+ * each, over the windowed frame capture_take() left in fft_buff. Other
+ * bars of spectrum[] are 0, levels match fft_output(). harmonic_sum()
+ * then only weighs candidates around f/2, f and 3f/2 (f/2 scores f and
+ * 3f/2 as its harmonics), see goertzel_candidate(); ANALYSE_PEAKS
+ * finds its peaks in the same bands.
+ *
+ * Each bar costs O(FFT_N), so this beats the FFT only with narrow
+ * bands; 'make bench' has both.
+ **********************************************************************/
+
+/* Samples are taken >> log2(FFT_N): keeps the filter state within 17
+ * bits for bars between FFT_N/16 and 7*FFT_N/16, so the Q14 products
+ * fit into 32 bits */
+#if FFT_N == 1024
+#define GOERTZEL_SHIFT	10
+#elif FFT_N == 512
+#define GOERTZEL_SHIFT	9
+#elif FFT_N == 256
+#define GOERTZEL_SHIFT	8
+#elif FFT_N == 128
+#define GOERTZEL_SHIFT	7
+#else
+#define GOERTZEL_SHIFT	6
+#endif
+
+/* Integer square root, rounded down */
+static uint16_t isqrt32(uint32_t x)
+{
+	uint32_t root = 0, bit = 1UL << 30;
+
+	while (bit > x)
+		bit >>= 2;
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+/* Windowed sample n of the frame in fft_buff */
+static inline int16_t goertzel_sample(const int n)
+{
+#if INPUT_REAL
+	return ((const int16_t *)v.fft_buff)[n];
+#else
+	return v.fft_buff[n].r;
+#endif
+}
+
+/* 2 |X[k]| / FFT_N, like fft_output() */
+static uint16_t goertzel_bar(const int k)
+{
+	/* cos and sin of the bar in Q14 */
+	const int16_t c = (int16_t)pgm_read_word_near(&tbl_cos_sin[2 * k]) >> 1;
+	const int16_t s = (int16_t)pgm_read_word_near(&tbl_cos_sin[2 * k + 1]) >> 1;
+	int32_t s0, s1 = 0, s2 = 0;
+	int32_t re, im;
+	int n;
+
+	for (n = 0; n < FFT_N; n++) {
+		/* s0 = x + 2 cos * s1 - s2, rounded */
+		s0 = (goertzel_sample(n) >> GOERTZEL_SHIFT)
+			+ ((c * s1 + (1L << 12)) >> 13) - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+
+	re = s1 - ((c * s2) >> 14);
+	im = (s * s2) >> 14;
+	return isqrt32((uint32_t)(re * re) + (uint32_t)(im * im)) * 2;
+}
+
+static inline void goertzel_spectrum(void)
+{
+	int band, k;
+
+	memset(spectrum, 0, sizeof(spectrum));
+	for (band = 1; band <= 3; band++) {
+		const int bar = band * FFT_N / 8;
+		for (k = bar - GOERTZEL_SPAN; k <= bar + GOERTZEL_SPAN; k++)
+			spectrum[k] = goertzel_bar(k);
+	}
+}
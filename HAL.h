@@ -0,0 +1,58 @@
+/**********************************************************************
+ * avr_tuner - hardware abstraction
+ * Copyright (C) 2010 by Tomasz bla Fortuna <bla@thera.be>
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Main.c only talks to the hardware through four small interfaces,
+ * each implemented once for the ATmega32 (files in the top directory)
+ * and once for the host build (files in host/, selected with -DHOST):
+ *
+ *  sample source  - Board.c:  adc_init(), adc_rate(); calls
+ *                   adc_sample() (defined in Main.c) with every 10-bit
+ *                   conversion, one per adc_rate() period.
+ *  tick source    - the sample source itself; adc_sample() increments
+ *                   tick and posts the timed events of Sched.c, so all
+ *                   timing is counted in ADC conversions.
+ *  display sink   - LCD.c:    lcd_init(), lcd_send(), lcd_print(), ...
+ *                   draw into a framebuffer, lcd_flush() marks the end
+ *                   of a complete screen and sends what changed.
+ *  debug stream   - Serial.c: serial_init() binds stdout.
+ *
+ * Board.c also carries the few remaining pins: button and IR LED.
+ **********************************************************************/
+
+#ifndef _HAL_H_
+#define _HAL_H_
+
+/* Nominal conversion rate; each note sets its own (Tuner.c notes[])
+ * within ~12% of it, timeouts counted in ticks assume this one */
+#define ADC_HZ 3000.0
+
+/* adc_rate() argument for a conversion rate */
+#define ADC_OCR(hz) ((uint16_t)(F_CPU / (double)(hz) + 0.5) - 1)
+
+#ifdef HOST
+
+#include "host/HAL.h"
+
+#else
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/pgmspace.h>
+#include <util/delay.h>
+
+/* Busy-wait body; nothing to do, interrupts move the world */
+#define hal_wait()
+
+/* Note selected after power-on, NOTE_SCAN for auto */
+#ifdef AUTO_NOTE
+#define HAL_START_NOTE NOTE_SCAN
+#else
+#define HAL_START_NOTE NOTE_E2
+#endif
+
+#endif
+
+#endif
@@ -3,6 +3,14 @@
  * (C) 2004 by Tomasz bla Fortuna
  *
  * NOTE: This functions have by default RW low. And RS high.
+ *
+ * lcd_clear(), lcd_goto(), lcd_send() and lcd_print() only write the
+ * 8x2 framebuffer lcd_fb. lcd_flush() compares it with what the display
+ * shows and queues the cells that changed; the Timer0 compare interrupt
+ * sends one queued byte every 64 us (HD44780 takes ~40 us per write), so
+ * the main loop never waits for the display. lcd_init() and
+ * lcd_chars() still write directly, they only run at power-on while
+ * the first frame is captured.
  */
 #define LCDPort		PORTC	/* 4 pins port */
 #define LCDDDR          DDRC
@@ -21,11 +29,26 @@
 #define lcd_display_on	1
 #define lcd_display_off	0
 
+#define LCD_COLS	8
+#define LCD_ROWS	2
+
+/* Queue of bytes for the display, a power of two that holds a whole
+ * screen: 16 cells + 2 addresses. Bytes with bit 7 set are Set DDRAM
+ * Address commands, the rest characters (ASCII or the 8 custom ones). */
+#define LCD_QUEUE	32
+
 /* Private */
 uint8_t LCDx, LCDy;
 
+/* Next screen, and what the display shows once the queue has run */
+static uint8_t lcd_fb[LCD_ROWS][LCD_COLS];
+static uint8_t lcd_shown[LCD_ROWS][LCD_COLS];
+
+static uint8_t lcd_queue[LCD_QUEUE];
+static volatile uint8_t lcd_queue_head, lcd_queue_tail;
+
 /* Lowlevel function sending byte to LCD controller */
-void lcd_send(const uint8_t byte)
+static void lcd_write(const uint8_t byte)
 {
 	unsigned char nibble;
 	LCDCPort &= ~LCD_RW;
@@ -67,52 +90,87 @@ static inline void lcd_init()
 	usleep(2);
 	LCDCPort &= ~LCD_E;
 	
-	lcd_send(0x2C);		/* Function Set: 4bit bus; 2 lines; 5x11 font */
+	lcd_write(0x2C);		/* Function Set: 4bit bus; 2 lines; 5x11 font */
 	usleep(45);
-	lcd_send(0x2C);		/* Function Set: 4bit bus; 2 lines; 5x11 font */
+	lcd_write(0x2C);		/* Function Set: 4bit bus; 2 lines; 5x11 font */
 	usleep(45);
-	lcd_send(0x0C);		/* Display Control: Display: ON; Cursor OFF; Blink OFF */
+	lcd_write(0x0C);		/* Display Control: Display: ON; Cursor OFF; Blink OFF */
 	usleep(45);
-	lcd_send(0x01);		/* Clear display */
+	lcd_write(0x01);		/* Clear display */
 	msleep(2);		/* 1.53ms */
-	lcd_send(0x06);		/* Entry Mode Set: Increment address; No shift */
+	lcd_write(0x06);		/* Entry Mode Set: Increment address; No shift */
 	usleep(45);
 
 	LCDx = 0; LCDy = 0;
+	memset(lcd_fb, ' ', sizeof(lcd_fb));
+	memset(lcd_shown, ' ', sizeof(lcd_shown));
 
 	LCDCPort |= LCD_RS;
+
+	/* Timer0: CTC, clk/8, compare every 64 us; enabled by lcd_flush() */
+	OCR0 = F_CPU / 8 / 1000000 * 64 - 1;
+	TCCR0 = (1<<WGM01) | (1<<CS01);
+}
+
+/* Sends the oldest queued byte; stops the interrupt once it's empty */
+ISR(TIMER0_COMP_vect)
+{
+	const uint8_t tail = lcd_queue_tail;
+	uint8_t byte;
+
+	if (tail == lcd_queue_head) {
+		TIMSK &= ~(1<<OCIE0);
+		return;
+	}
+	byte = lcd_queue[tail];
+	if (byte & 0x80)
+		LCDCPort &= ~LCD_RS;
+	lcd_write(byte);
+	LCDCPort |= LCD_RS;
+	lcd_queue_tail = (tail + 1) & (LCD_QUEUE - 1);
+}
+
+/* Queue a byte, 0 if the queue is full */
+static inline uint8_t lcd_queue_put(const uint8_t byte)
+{
+	const uint8_t head = lcd_queue_head;
+	const uint8_t next = (head + 1) & (LCD_QUEUE - 1);
+
+	if (next == lcd_queue_tail)
+		return 0;
+	lcd_queue[head] = byte;
+	lcd_queue_head = next;
+	return 1;
 }
 
 /* Goto XY location */
 void lcd_goto(uint8_t x, uint8_t y)
 {
-	uint8_t Address;
-	Address = (y*64+x) | 0x80;	/* Set DDRAM Address */
-	LCDCPort &= ~LCD_RS;
-	usleep(50);
-	lcd_send(Address);
-	usleep(45);
-	LCDCPort |= LCD_RS;
 	LCDx = x; LCDy = y;
 }
 
 /* Clears LCD and goes to first location on display */
 void lcd_clear()
 {
-	LCDCPort &= ~LCD_RS;
-	lcd_send(0x01);
-	msleep(2);		/* 1.53ms */
-	LCDCPort |= LCD_RS;
+	memset(lcd_fb, ' ', sizeof(lcd_fb));
 	LCDx = 0; LCDy = 0;
 }
 
+/* Character at the cursor, which moves right */
+void lcd_send(const uint8_t byte)
+{
+	if (LCDx < LCD_COLS && LCDy < LCD_ROWS)
+		lcd_fb[LCDy][LCDx] = byte;
+	LCDx++;
+}
+
 void lcd_display(uint8_t status)
 {
 	LCDCPort &= ~LCD_RS;
 	if (status == lcd_display_on)
-		lcd_send(0x0D);
+		lcd_write(0x0D);
 	else
-		lcd_send(0x09);
+		lcd_write(0x09);
 	usleep(45);
 	LCDCPort |= LCD_RS;
 }
@@ -126,51 +184,93 @@ void lcd_print(const char *string)
 			if (LCDy == 0) {
 				LCDy = 1;
 				LCDx = 0;
-				lcd_goto(0, 1);
 			}
 		} else {
 			if ((LCDx == 8) && (LCDy == 1)) break;
-			/* if ((LCDx == 16) && (LCDy == 0)) lcd_goto(0,1); */
 			lcd_send(*ch);
-			LCDx++;
-			usleep(45);
 		}
 	}
 }
 
 
+/* Custom characters 1..7 (CGRAM from 8 on): a bar in column 0..4 of
+ * the cell for the error, then the two marks of the center */
+static const uint8_t lcd_glyphs[7][8] PROGMEM = {
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+	{0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08},
+	{0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+	{0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02},
+	{0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01},
+	{0x10, 0x18, 0x10, 0x18, 0x10, 0x18, 0x10, 0x18},
+	{0x01, 0x03, 0x01, 0x03, 0x01, 0x03, 0x01, 0x03},
+};
+
+/* Uploads the glyphs in one burst, each write as soon as the HD44780
+ * takes the next (37 us) */
 static inline void lcd_chars()
 {
-        LCDCPort &= (unsigned int) ~LCD_RS;
-        lcd_send(0x40 + 8);                  /* Set CGRAM address to 0+8; Select CGRAM */
-        usleep(45);
-
-        LCDCPort |= LCD_RS;
-
-        unsigned char byte = (1<<4);
-        unsigned char i;
-        unsigned char y;
-        for (i=0; i<5; i++) {
-	        for (y=0; y<8; y++) {
-		        lcd_send(byte);
-		        usleep(45);
-	        }
-	        byte >>= 1;
-        }
-
-        /* For center */
-        byte = (1<<4);
-        for (y=0; y<8; y++) {
-	        lcd_send(byte);
-	        byte ^= (1<<3);
-	        usleep(45);
-        }
-        byte = 1;
-        for (y=0; y<8; y++) {
-	        lcd_send(byte);
-	        byte ^= (1<<1);
-	        usleep(45);
-        }
-
-        lcd_goto(LCDx,LCDy);             /* Return to DDRAM. */
+	const uint8_t *p = &lcd_glyphs[0][0];
+	uint8_t i;
+
+	LCDCPort &= ~LCD_RS;
+	lcd_write(0x40 + 8);			/* Set CGRAM address to 0+8; Select CGRAM */
+	usleep(40);
+	LCDCPort |= LCD_RS;
+
+	for (i = 0; i < sizeof(lcd_glyphs); i++) {
+		lcd_write(pgm_read_byte_near(p++));
+		usleep(37);
+	}
+
+	LCDCPort &= ~LCD_RS;
+	lcd_write(0x80);			/* Return to DDRAM. */
+	usleep(40);
+	LCDCPort |= LCD_RS;
+}
+
+/* Screen is complete: queue the cells that changed, an address only
+ * before the first of a run. A full queue leaves the rest for the
+ * next flush. */
+static void lcd_flush(void)
+{
+	uint8_t x, y, addr = 0xFF;
+
+	for (y = 0; y < LCD_ROWS; y++) {
+		for (x = 0; x < LCD_COLS; x++) {
+			const uint8_t c = lcd_fb[y][x];
+
+			if (c == lcd_shown[y][x])
+				continue;
+			if (addr != (y * 64 + x)) {
+				if (!lcd_queue_put(0x80 | (y * 64 + x)))
+					goto full;
+			}
+			if (!lcd_queue_put(c))
+				goto full;
+			lcd_shown[y][x] = c;
+			addr = y * 64 + x + 1;
+		}
+	}
+full:
+	if (lcd_queue_head != lcd_queue_tail)
+		TIMSK |= (1<<OCIE0);
+}
+
+/* Sends whatever is queued right away, for when interrupts are off */
+static void lcd_drain(void)
+{
+	uint8_t sreg = SREG;
+
+	cli();
+	while (lcd_queue_tail != lcd_queue_head) {
+		const uint8_t byte = lcd_queue[lcd_queue_tail];
+
+		if (byte & 0x80)
+			LCDCPort &= ~LCD_RS;
+		lcd_write(byte);
+		LCDCPort |= LCD_RS;
+		usleep(45);
+		lcd_queue_tail = (lcd_queue_tail + 1) & (LCD_QUEUE - 1);
+	}
+	SREG = sreg;
 }
@@ -38,11 +38,9 @@
 #include <string.h>
 #include <inttypes.h>
 
-#include <avr/io.h>
-#include <avr/interrupt.h>
-#include <avr/sleep.h>
-#include <avr/pgmspace.h>
-#include <util/delay.h>
+#include "Config.h"
+#include "HAL.h"
+#include "Num.h"
 
 // #define DEBUG
 
@@ -54,198 +52,205 @@
 #endif
 
 /*** Local includes ***/
+#include "Sched.c"
+#include "Prof.c"
+#ifdef HOST
+#include "host/Sleep.c"
+#include "host/Board.c"
+#include "host/LCD.c"
+#include "host/Serial.c"
+#else
 #include "Sleep.c"
+#include "Board.c"
 #include "LCD.c"
 #include "Serial.c"
+#endif
 
+/* Errors 1 .. 3 come from the self test, 4 from the stack check */
 static void error(const char what)
 {
 	lcd_clear();
 	lcd_send(what + '0');
-	usleep(45);
-	lcd_print(" SENSOR\n ERROR!");
+	lcd_print(what == 4 ? " STACK\n ERROR!" : " SENSOR\n ERROR!");
+	lcd_flush();
+	/* Also called with interrupts off */
+	lcd_drain();
 }
 
-void button_init(void)
+#include "Stack.c"
+
+#ifndef PITCH_YIN
+#include "Peak.c"
+#endif
+#include "Tuner.c"
+#if defined(PITCH_YIN)
+#include "Yin.c"
+#elif defined(SPECTRUM_GOERTZEL)
+#include "Goertzel.c"
+#endif
+#ifdef AUTO_NOTE
+#include "Auto.c"
+#endif
+#ifdef TELEMETRY
+#include "Telemetry.c"
+#endif
+
+#ifdef CAPTURE_DOUBLE
+/* Ring of the last FFT_N raw samples, the newest frame starts at pos
+ * and wraps around; fft_input_ring() windows it from there */
+static int16_t capture_buff[FFT_N];     /* 256 bytes */
+volatile static uint16_t capture_pos;   /* Next write = oldest sample */
+volatile static uint16_t capture_left;  /* Samples until EV_FRAME */
+#else
+/* Raw samples from the ADC interrupt, kept inside fft_buff where
+ * fft_input() reads each one before it overwrites it: in place with
+ * INPUT_REAL, the upper half of the complex_t array without */
+#if INPUT_REAL
+#define capture_raw ((int16_t *)v.fft_buff)
+#else
+#define capture_raw ((int16_t *)v.fft_buff + FFT_N)
+#endif
+const int16_t *capture_end = capture_raw + FFT_N;
+volatile int16_t * volatile capture_cur = capture_raw + FFT_N;
+#endif
+
+/* OR of |sample| stored since capture_take() last took it */
+volatile static uint16_t capture_peak;
+
+/* Decimator: 2nd order CIC, integrators run at the ADC rate and the
+ * combs once per divisor conversions (adc_sample()). Unsigned, so
+ * integrators wrap around harmlessly; 10 bit input + 2 * log2(divisor)
+ * fits. */
+static uint32_t cic_int1, cic_int2, cic_comb1, cic_comb2;
+static uint8_t cic_left = 1;
+
+/* Outputs left that still span samples from before cic_reset() */
+static uint8_t cic_settle;
+
+/* Start the decimator over at the divisor of current_note (interrupts
+ * off), so no output mixes the old rate and the new one. The first
+ * output covers only half the filter and is dropped. */
+static inline void cic_reset(void)
 {
-	DDRB &= ~(1<<PB2);
-	PORTB |= (1<<PB2);
+	cic_int1 = cic_int2 = cic_comb1 = cic_comb2 = 0;
+	cic_left = notes[current_note].divisor;
+	cic_settle = 1;
 }
 
-char button_clicked(void)
+/* Block exponent of a frame: left shift bringing its peak to
+ * 16384 .. 32767, so quiet strings use the whole 16 bit range */
+static inline uint8_t capture_shift(uint16_t peak)
 {
-	return !(PINB & (1<<PB2));
+	uint8_t shift = 0;
+
+	while (peak < 0x4000 && shift < CAPTURE_SHIFT_MAX) {
+		peak <<= 1;
+		shift++;
+	}
+	return shift;
 }
 
-/************************************************************************************************************
- * Guitar tunner - NOTES
- *
- * FFT_N = 256
- * FFT_N / 2 = max Hz
- * Musi wej FFT_N/4 penych okresw danej czstotliwoci
- * f = 10^6 / prescaler / 13 / divider
- *
- *      f [Hz]   T [s]   f * (FFT_N/4)   prescaler
- * E   329.628 .0030337  21096.192       64  -> 19230 Hz
- * H   246.942 .0040495  15804.288
- * G   195.998 .0051021
- * D   146.832 .0068105
- * A   110.000 .0090909
- * E2   82.407 .0121349   5274.048
- *
- * Formula:
- * Clock / ADCPrescaler / 13 / Divider / 2 * (BAR / 64) = Hz
- * We are trying to hit 32 BAR
- * 16*10^6 / 128 / 13 / D / 2  *  (32/64) = f
- * D = 2403.846153 / f
- * B = 0.026624 f D
- *
- *
- *  Measurements for data:
-	// f=82.407 presc=128 div=29 bar=32 err=0.48425 scale=64 
-	{29, 8240U, 3},
-	// f=110.000 presc=128 div=22 bar=32 err=0.73427 scale=64 
-	{22, 11000U, 3},
-	// f=146.832 presc=128 div=16 bar=31 err=1.28663 scale=64 
-	{16, 14683U, 5},
-	// f=195.998 presc=128 div=12 bar=31 err=1.93750 scale=64 
-	{12, 19599U, 7},
-	// f=246.942 presc=128 div=10 bar=33 err=0.95463 scale=64 
-	{10, 24694U, 8},
-	// f=329.628 presc=128 div=7 bar=31 err=3.04714 scale=64  
-	{7, 32962U, 10},
-
- * NOTE    Difference
- * E2.        OK
- * A.        116.94 ~ +7Hz
- * D.         OK
- * G         198.6  ~ +4
- * B         253.7  ~ +7
- * E         324    ~ -5
- */
-
-#include "FFT/ffft.h"
-
-
-/* FFT Buffers and data*/
-#define v(x) v.vars.x
-
-/* num_t has 2 decimal places. */
-typedef int32_t num_t;
-
-/*** Constants ***/
-const char spectrum_min = 10;
-const char spectrum_max = FFT_N/2 - 10;
-const int harm_max = 4;
-
-/*** Buffers + Variables ***/
-union {
-	/* Buffer we store captured data in
-	 * inside FFT is calculated and then transposed
-	 * into spectrum */
-	complex_t fft_buff[FFT_N];   /* 512 bytes */
-
-	/* After fft_buff is unused we can use it's memory
-	 * to hold variables required during analysis */
-	struct {
-		/* Generic helper for calculating averages */
-		uint16_t avg_helper;
-
-		/* For locating maximas */
-		uint32_t avg_global;
-
-		uint16_t running_avg;
-		char dist_between_max;
-
-		/* Number of harmonics found */
-		int harm_cnt;
-
-		/* Index of the one with biggest wage + it's wage */
-		int harm_main;
-		uint16_t harm_main_wage;
-
-		/* Harmonics found + their wages */
-		num_t harm_freq[4];
-		int16_t harm_bar[4];
-		uint16_t harm_wage[4];
-
-		/* Averaging correct frequency */
-		num_t avg_freq;
-
-		/* Buffers of lcd_update */
-		char lcd_buff[20];
-
-		/* For function num2str */
-		int16_t rest;
-		char num2str_buff[20];
-	} vars;
-} v;
-
-/* Final version of spectrum for analysis */
-uint16_t spectrum[FFT_N/2];  /* 128 bytes */
-
-/* Buffer traversing for ADC interrupt */
-volatile const prog_int16_t *window_cur = tbl_window;
-const complex_t *fft_buff_end = &v.fft_buff[FFT_N];
-volatile complex_t * volatile fft_buff_cur = &v.fft_buff[FFT_N];
-
-/* Resulting frequency is averaged further */
-static num_t avg_freq_running;
-
-/* And ignored after some time of no measurements */
-static uint16_t avg_freq_running_time;
-
-/* Incremented in ADC with 16*10^6/ 128 / 13 = 9615 Hz freq */
-volatile static uint32_t tick, button_delay;
-volatile static char clicked;
-
-/*** NOTE data ***/
-
-/* Current selected note (divisor is required
- * for gathering windowed data) */
-static unsigned int current_note;
-
-enum { NOTE_E2 = 0, NOTE_A, NOTE_D, NOTE_G, NOTE_B, NOTE_E };
-struct {
-	char name;
-	char divisor;
-	uint16_t freq; /* Make it num_t? FIXME */
-	int16_t time_relevant; /* Time in which running average of freq is relevant */
-	int16_t correction;
-} notes[] = {
-	/* f=82.407 presc=128 div=29 bar=32 err=0.48425 scale=64  */
-	{'E', 29, 8240U, 3, 0},
-	/* f=110.000 presc=128 div=22 bar=32 err=0.73427 scale=64  */
-	{'A', 22, 11000U, 3, -650},
-	/* f=146.832 presc=128 div=16 bar=31 err=1.28663 scale=64  */
-	{'D', 16, 14683U, 5, 0},
-	/* f=195.998 presc=128 div=12 bar=31 err=1.93750 scale=64  */
-	{'G', 12, 19599U, 7, -350},
-	/* f=246.942 presc=128 div=10 bar=33 err=0.95463 scale=64  */
-	{'B', 10, 24694U, 8, -750},
-	/* f=329.628 presc=128 div=7 bar=31 err=3.04714 scale=64  */
-	{'e', 7, 32962U, 10, 500},
-};
-
-
-/* Initialize data for capture, select tone */
-static inline void do_capture(const int new_note)
+/* Button debouncing, counted in ADC ticks */
+volatile static uint16_t button_delay;
+
+/* Sensor check of the raw conversions after power-on, while the
+ * display starts and the first frame is captured (EV_SELFTEST). The
+ * IR LED stays off for the first SELFTEST_DARK of them, so min/max
+ * span ambient light and the lit string like the old blinking did. */
+#define SELFTEST_TICKS ((uint16_t)(ADC_HZ / 10))
+#define SELFTEST_DARK ((uint16_t)(ADC_HZ / 50))
+volatile static uint16_t selftest_left = SELFTEST_TICKS;
+volatile static uint16_t selftest_dark = SELFTEST_DARK;
+volatile static uint16_t selftest_min = 0xFFFF, selftest_max;
+
+/* The HD44780 wants 40 ms after power-on */
+#define LCD_POWER_TICKS ((uint16_t)(ADC_HZ * 0.045))
+
+
+#ifdef CAPTURE_DOUBLE
+/* Peaks of the last hops; every hop is CAPTURE_HOP samples or more,
+ * so these cover the whole frame */
+static uint16_t hop_peak[CAPTURE_FRAMES];
+static uint8_t hop;
+
+/* Capture at the rate of a note; the ring holds samples taken at the
+ * old one, so EV_FRAME waits for a whole frame */
+static inline void capture_note(const uint8_t note)
 {
-	current_note = new_note;
+	cli();
+	current_note = note;
+	adc_rate(notes[note].ocr);
+	cic_reset();
+	capture_left = FFT_N;
+	capture_peak = 0;
+	sei();
+	memset(hop_peak, 0, sizeof(hop_peak));
+}
 
-	window_cur = tbl_window;
-	fft_buff_cur = v.fft_buff;
+/* Window the newest FFT_N samples into fft_buff (EV_FRAME), the next
+ * EV_FRAME comes a hop later */
+static inline void capture_take(void)
+{
+	uint16_t start, peak;
+	int i;
 
-#if DEBUG
-	while (fft_buff_cur != fft_buff_end);
+	cli();
+	start = capture_pos;
+	capture_left = CAPTURE_HOP;
+	hop_peak[hop] = capture_peak;
+	capture_peak = 0;
+	sei();
+
+	if (++hop == CAPTURE_FRAMES)
+		hop = 0;
+	for (peak = 0, i = 0; i < CAPTURE_FRAMES; i++)
+		peak |= hop_peak[i];
+	spectrum_exp = capture_shift(peak);
+
+	/* ADC overwrites the frame from its start, but no sooner than a
+	 * conversion later; fft_input_ring() is far ahead by then */
+#ifdef PITCH_YIN
+	yin_input(capture_buff, start, spectrum_exp);
 #else
-	set_sleep_mode(SLEEP_MODE_ADC);
-	while (fft_buff_cur != fft_buff_end) sleep_mode();
+	fft_input_ring(capture_buff, start, v.fft_buff, spectrum_exp);
 #endif
 }
+#else
+/* Fill fft_buff again, EV_FRAME once it is full */
+static inline void capture_restart(void)
+{
+	cli();
+	capture_peak = 0;
+	capture_cur = capture_raw;
+	sei();
+}
+
+/* Capture at the rate of a note */
+static inline void capture_note(const uint8_t note)
+{
+	cli();
+	current_note = note;
+	adc_rate(notes[note].ocr);
+	cic_reset();
+	sei();
+	capture_restart();
+}
 
-/* Reads data from ADC */
-ISR(ADC_vect)
+/* Window the whole frame at once, out of the interrupt (EV_FRAME); the
+ * capture stays stopped until capture_restart() */
+static inline void capture_take(void)
+{
+	spectrum_exp = capture_shift(capture_peak);
+#ifdef PITCH_YIN
+	yin_input(capture_raw, 0, spectrum_exp);
+#else
+	fft_input(capture_raw, v.fft_buff, spectrum_exp);
+#endif
+}
+#endif
+
+/* Handles every ADC conversion (called from ADC interrupt) */
+static inline void adc_sample(const int16_t adc)
 {
 	/* Current measurement */
 	static int16_t adc_cur;
@@ -253,19 +258,44 @@ ISR(ADC_vect)
 	/* Estimated Light background */
 	static int16_t background;
 
-	/* Used for additional dropping of incomming data */
-	static char i;
+	uint32_t comb1, comb2;
 
 	/* Read measurement. It will get averaged */
-	adc_cur = ADC - 512;
+	adc_cur = adc - 512;
+
+	if (selftest_left) {
+		if (adc < selftest_min)
+			selftest_min = adc;
+		if (adc > selftest_max)
+			selftest_max = adc;
+		if (!--selftest_left)
+			sched_events |= EV_SELFTEST;
+	}
 
 	/* Some general periodic tasks. Check button increment counter */
 	tick++;
+	if (!--lcd_tick) {
+		lcd_tick = LCD_TICKS;
+		sched_events |= EV_DISPLAY;
+	}
 	if (button_delay) {
 		--button_delay;
 	} else if (button_clicked()) {
-		clicked = 1;
-		button_delay = 5000;
+		sched_events |= EV_BUTTON;
+		button_delay = (uint16_t)(ADC_HZ / 2);
+	}
+
+	/* Dark part of the sensor check: none of it is captured. The LED
+	 * goes on a conversion ahead; the background and the decimator
+	 * start over from the first lit one. */
+	if (selftest_dark) {
+		if (--selftest_dark) {
+			if (selftest_dark == 1)
+				ir_on();
+			return;
+		}
+		background = adc_cur;
+		cic_reset();
 	}
 
 	/* Calculate background all the time */
@@ -273,466 +303,300 @@ ISR(ADC_vect)
 	background += adc_cur;
 	background /= 8;
 
-	/* Ignore saving if buffer is full */
-	if (fft_buff_cur == fft_buff_end)
+	/* Remove background, filter every conversion, keep every
+	 * divisor-th output; sinc^2 response, so what would alias onto
+	 * the analysed band is damped instead of dropped straight in */
+	cic_int1 += (int32_t)(adc_cur - background);
+	cic_int2 += cic_int1;
+	if (--cic_left)
 		return;
-
-	/* Increment divisor and drop some results */
-	if (++i % notes[current_note].divisor != 0)
+	cic_left = notes[current_note].divisor;
+
+	comb1 = cic_int2 - cic_comb1;
+	cic_comb1 = cic_int2;
+	comb2 = comb1 - cic_comb2;
+	cic_comb2 = comb1;
+	if (cic_settle) {
+		cic_settle--;
 		return;
+	}
 
-	/* Remove background and multiply to better fit FFT algorithm */
-	adc_cur -= background;
-	adc_cur *= 1000;
+	/* Mean times 16; capture_take() shifts the frame up to full scale */
+	adc_cur = ((int32_t)comb2 * notes[current_note].cic_gain) >> 12;
 
-	/* Store */
-	const int16_t tmp = fmuls_f(adc_cur, pgm_read_word_near(window_cur));
-	fft_buff_cur->r = fft_buff_cur->i = tmp;
+#ifndef CAPTURE_DOUBLE
+	/* Ignore saving if buffer is full */
+	if (capture_cur == capture_end)
+		return;
+#endif
+
+	/* Store raw, fft_input() windows the whole frame later */
+	capture_peak |= adc_cur < 0 ? -adc_cur : adc_cur;
+#ifdef CAPTURE_DOUBLE
+	capture_buff[capture_pos] = adc_cur;
+	if (++capture_pos == FFT_N)
+		capture_pos = 0;
 
-	/* Increment buffers */
-	fft_buff_cur++;
-	window_cur++;
+	if (capture_left && --capture_left == 0)
+		sched_events |= EV_FRAME;
+#else
+	*capture_cur++ = adc_cur;
+	if (capture_cur == capture_end)
+		sched_events |= EV_FRAME;
+#endif
 }
 
-static const char *num2str(num_t number)
+/* Fill fft_buff with a pattern, memory_check() reads it back after the
+ * display power-up (LCD_POWER_TICKS): the first capture writes into
+ * fft_buff straight after, so the pattern only spans those 45 ms */
+static inline void memory_fill(void)
 {
-	v(rest) = number % 100;
-	if (v(rest) < 0) v(rest) = -v(rest);
-
-	itoa((int16_t)(number/100L), v(num2str_buff), 10);
-	const int pos = strlen(v(num2str_buff));
-	v(num2str_buff)[pos] = '.';
-	itoa(v(rest), v(num2str_buff)+pos+1, 10);
+	int count;
 
-	return v(num2str_buff);
+	for (count = 0; count < FFT_BFLY; count++) {
+		v.fft_buff[count].i = count;
+		v.fft_buff[count].r = 32000 - count;
+	}
 }
 
-#define int2num(x) (100L*x)
-
-/* Convert accurate bar position (two decimal places)
- * into frequency according to current note divisor */
-static inline num_t bar2hz(const num_t bar)
+/* Check if memory still holds it's values */
+static inline void memory_check(void)
 {
-	/* solve(16*10^6 / 64 / 13 / D / 2  *  (B/64) = f, f),numer;   */
-	/* for prescaler / 128: f = 75.1201923 * B / D */
-	return ((7512UL * bar) / notes[current_note].divisor) / 100L;
-}
+	int count;
 
-static inline void lcd_update(void)
-{
-	static int i;
-//	const int32_t error = ((avg_freq_running - notes[current_note].freq) * 10000 / notes[current_note].freq) / 3 + 20;
-	const int32_t error = 
-		((avg_freq_running - notes[current_note].freq) * 3 / 100) + 20;
-	const int pos = (error-1)/5;
-
-	if (tick < 2400) {
-		/* Don't update too often */
-		return;
+	for (count=0; count < FFT_BFLY; count++) {
+		if (v.fft_buff[count].i != count ||
+		    v.fft_buff[count].r != 32000 - count) {
+			cli();
+			for (;;) error(3);
+		}
 	}
+}
 
-	lcd_clear();
+/*** Tasks of the Sched.c events ***/
 
-	if (tick > 32000) {
-		lcd_print("-- \x07\x06 --");
-		tick = 32000;
-	} else {
-		/* Code error in range 0 30 - 15 meaning no error */
-		if (error <= 0) {
-			lcd_print("<");
-		} else if (error > 40) {
-			lcd_print("       >");
-		} else {
-			lcd_goto(pos, 0);
-			lcd_send(1 + (error-1) % 5);
-			usleep(45);
-		}
-
-		/* Mark center */
-		if (pos == 3) {
-			lcd_goto(4, 0);
-			lcd_send(6);
+/* A dead or saturated sensor, a dead IR LED (in steady light) or a
+ * stuck ADC shows an error and is checked again, dark part included,
+ * until it recovers */
+static inline void task_selftest(void)
+{
+	for (;;) {
+		if (selftest_max < 10 || selftest_min > 800) {
+			printf("Self-test failed min/max %d/%d\n", selftest_min, selftest_max);
+			error(1);
+		} else if (selftest_max == selftest_min) {
+			printf("Self-test failed min=max=%d\n", selftest_min);
+			error(2);
 		} else {
-			lcd_goto(3, 0);
-			lcd_send(7);
+			break;
 		}
-		usleep(45);
-	}
 
-	for (i=1; i<sizeof(v(lcd_buff)); i++)
-		v(lcd_buff)[i] = ' ';
-	*v(lcd_buff) = notes[current_note].name;
-
-	if (tick >= 32000) {
-		strcpy(v(lcd_buff)+2, "SZARP!");
-	} else { 
-		/* 01234567
-		 * N_123.34  LEN=6, 8-LEN
-		 */
-		const char *freq = num2str(avg_freq_running - notes[current_note].freq);
-		const int len = strlen(freq);
-		for (i=0; i<len; i++) {
-			v(lcd_buff)[8-len + i] = freq[i];
-		}
+		cli();
+		ir_off();
+		selftest_min = 0xFFFF;
+		selftest_max = 0;
+		selftest_left = SELFTEST_TICKS;
+		selftest_dark = SELFTEST_DARK;
+		sei();
+		while (selftest_left) hal_wait();
 	}
+	sched_cancel(EV_SELFTEST);
 
-	lcd_goto(0, 1);
-	lcd_print(v(lcd_buff));
+	lcd_clear();
+	lcd_print("Init OK");
+	lcd_flush();
 }
 
-/* Method: Calculating frequency */
-static inline num_t estimate_bar(const int16_t bar)
+/* Next string; a frame in flight was taken at the old rate, the
+ * running average belongs to the old string. Shown right away. */
+static inline void task_button(void)
 {
-	int32_t avg;
-	int32_t avg_sum;
-	int i;
-
-	avg = avg_sum = 0;
-	for (i=1; i<=7; i++) {
-		const int32_t s = spectrum[bar + i - 4];
-		avg += i * s;
-		avg_sum += s;
+	uint8_t note = current_note < NOTE_E ? current_note + 1 : NOTE_E2;
+
+#ifdef AUTO_NOTE
+	/* auto, E2 .. E, auto */
+	if (note_auto) {
+		note_auto = 0;
+		note = NOTE_E2;
+	} else if (current_note == NOTE_E) {
+		note_auto = 1;
+		note = NOTE_SCAN;
 	}
-	avg *= 100;
-	avg /= avg_sum;
-	avg -= 400;
-	avg_sum /= 7; /* Calculate neighborhood average */
-
-	if (avg_sum + 5 > spectrum[bar])
-		return 0;
-	else
-		return (num_t)bar*100L + avg;
+	auto_note = auto_next = AUTO_STAY;
+	auto_missed = 0;
+#endif
+	capture_note(note);
+	sched_cancel(EV_FRAME_STEPS);
+
+	avg_freq_running_time = 0;
+	tick = TICK_IDLE;
+	sched_post(EV_DISPLAY);
 }
 
-static inline void spectrum_analyse(void)
+/* Take the frame and transform it */
+static inline void task_frame(void)
 {
-	/* Maximas:
-	 * We should see our main freq at 64 bar it's harmonics: 32, 96
-	 * We should see our main freq at note_bar it's harmonics:
-	 * note_bar-32, note_bar+96
-	 */
-	int i, m;
-	uint16_t s;
-
-	v(avg_global) = v(avg_helper) = 0;
-
-	/* Precalculations:
-	 * 1) Calculate global maximum for reference and it's position
-	 * 2) Calculate average value for spectrum
-	 */
-	for (i = spectrum_min; i < spectrum_max; i++) {
-		/* Filter out rubbish */
-		s = (spectrum[i] /= 16);
-
-		if (s < 4)
-			continue;
-
-		/* Avg */
-		v(avg_global) += s;
-		v(avg_helper) += 1;
-	}
-
-	v(avg_global) = v(avg_helper) ? v(avg_global)/v(avg_helper) : 0;
-
-	/* Calculate positions of all harmonics */
-	v(harm_main_wage) = 0;
-	v(harm_main) = -1;
-	v(harm_cnt) = 0;
-
-	v(running_avg) = 0;
-	v(dist_between_max) = 0;
-
-	for (i = spectrum_min; i<spectrum_max; i++) {
-		s = spectrum[i];
-
-		if (v(dist_between_max)) {
-			v(dist_between_max)--;
-			goto not_max;
-		}
-
-		if (s <= v(running_avg) + 2)
-			goto not_max;
-
-		for (m=i-4; m <= i+4; m++) {
-			if (s < spectrum[m])
-				goto not_max;
-		}
-
-		if (s <= v(avg_global))
-			goto not_max;
-
-		const num_t real_bar = estimate_bar(i);
-		if (real_bar != 0) {
-			const num_t freq = bar2hz(real_bar);
-			printf("Bar=%d / %s ", i, num2str(real_bar));
-			printf("FREQ=%s Value=%u (avg=%lu)\n", num2str(freq), spectrum[i], v(avg_global));
-
-			if (s > v(harm_main_wage)) {
-				/* Update main harmonic */
-				v(harm_main_wage) = s;
-				v(harm_main) = v(harm_cnt);
-			}
-
-			v(harm_freq)[v(harm_cnt)] = freq;
-			v(harm_bar)[v(harm_cnt)] = i;
-			v(harm_wage)[v(harm_cnt)] = s;
-
-			v(harm_cnt)++;
-
-			if (v(harm_cnt) == harm_max)
-				break;
-
-			/* Keep distance between maxes */
-			v(dist_between_max) = 4;
-		}
-
-	not_max:
-		v(running_avg) += s;
-		v(running_avg) /= 2;
-	}
-
-	/* Count time for running freq so we will forget it after while */
-	if (avg_freq_running_time)
-		avg_freq_running_time--;
-
-	/* if there're 3 harmonics visible */
-	switch (v(harm_cnt)) {
-	case 3:
-		/* Do the average of all of them treating them sequentially */
-		v(avg_freq) = v(harm_freq)[1];
-		v(avg_freq) += v(harm_freq)[0] * 2;
-		v(avg_freq) += v(harm_freq)[2] * 2 / 3;
-		v(avg_freq) /= 3;
-		break;
-
-	case 2:
-		if (v(harm_bar)[0] < 25) {
-			v(avg_freq) = v(harm_freq)[0] * 2;
-			if (v(harm_bar)[1] < 38)
-				v(avg_freq) += v(harm_freq)[1];
-			else
-				v(avg_freq) += v(harm_freq)[1] * 2 / 3;
-		} else if (v(harm_bar)[0] < 38) {
-			v(avg_freq) = v(harm_freq)[0];
-			v(avg_freq) += v(harm_freq)[1] * 2 / 3;
-		} else {
-			/* Ok, something is wrong! */
-			printf("ERR:Something wrong (%d)\n", v(harm_bar)[0]);
-			return;
-		}
-
-		v(avg_freq) /= 2;
-		break;
-	default:
-		lcd_update();
+	PROF(PROF_CAPTURE, capture_take());
+#if defined(SPECTRUM_GOERTZEL) && !defined(PITCH_YIN)
+#ifdef AUTO_NOTE
+	/* A scan needs the whole band */
+	if (current_note != NOTE_SCAN)
+#endif
+	{
+		PROF(PROF_FFT, goertzel_spectrum());
+		sched_post(EV_ANALYSE);
 		return;
 	}
-
-
-	v(avg_freq) += notes[current_note].correction;
-
-	if (avg_freq_running_time) {
-		avg_freq_running += v(avg_freq);
-		avg_freq_running /= 2;
-	} else {
-		avg_freq_running = v(avg_freq);
-	}
-
-	avg_freq_running_time = notes[current_note].time_relevant;
-
-	printf("FREQUENCY         =%s\n", num2str(v(avg_freq)));
-	printf("RUNNING FREQUENCY =%s\n", num2str(avg_freq_running));
-
-	lcd_update();
-
-	if (notes[current_note].freq < avg_freq_running - int2num(1)) {
-		printf("TOO HIGH\n");
-	} else if (notes[current_note].freq > avg_freq_running + int2num(1)) {
-		printf("TOO LOW\n");
-	} else {
-		printf("TUNED\n");
-	}
-
-	/* Count time to next correct measurement */
-	tick = 0;
+#endif
+#ifndef PITCH_YIN
+	PROF(PROF_FFT, spectrum_exp += fft_execute(v.fft_buff));
+	PROF(PROF_OUTPUT, fft_output_band(v.fft_buff, spectrum,
+					  SPECTRUM_FIRST, SPECTRUM_COUNT));
+#endif
+	sched_post(EV_ANALYSE);
 }
 
-static inline void spectrum_display(void)
+static inline void task_analyse(void)
 {
-	static uint16_t s;
-	static int i, m;
-	const int wider = 10;
-
-	/* Horizontal spectrum: */
-	for (i = 60; i>0; i-=3) {
-		for (m = spectrum_min-wider; m < spectrum_max+wider; m++) {
-			s = spectrum[m];
-			if (s > i)
-				putchar('*');
-			else
-				putchar(' ');
-		}
-		putchar('\n');
-	}
-
-	for (i = spectrum_min-wider; i < spectrum_max+wider; i++)
-		if (i>=100)
-			putchar('1');
-		else
-			putchar(' ');
-	putchar('\n');
-
-	for (i = spectrum_min-wider; i < spectrum_max+wider; i++) {
-		const char tmp  = (i % 100)/10;
-		putchar(tmp + '0');
+	const uint8_t idle = tick >= TICK_IDLE;
+
+#ifdef AUTO_NOTE
+	if (current_note == NOTE_SCAN) {
+		PROF(PROF_ANALYSE, auto_next = auto_pick());
+		/* Nothing to show or send of a scan */
+		frequency_valid = 0;
+		v(harm_cnt) = 0;
+		sched_post(EV_DONE);
+		return;
 	}
-	putchar('\n');
-
-	for (i = spectrum_min-wider; i < spectrum_max+wider; i++)
-		putchar(i % 10 + '0');
-	putchar('\n');
-
-	putchar('\n');
+#endif
+#if defined(PITCH_YIN)
+	printf("\nNote=%d\n", current_note);
+	PROF(PROF_ANALYSE, yin_analyse());
+#else
+	printf("\nNote=%d freq=%s Divisor=%d\n", current_note, 
+	       num2str(notes[current_note].freq),
+	       notes[current_note].divisor);
+	PROF(PROF_ANALYSE, spectrum_analyse());
+#endif
+#ifdef PROFILE
+	if (frequency_valid && !prof_boot)
+		prof_boot = prof_now();
+#endif
+#ifdef AUTO_NOTE
+	if (note_auto && auto_rescan())
+		auto_next = NOTE_SCAN;
+#endif
+	/* The first reading after the idle screen shows right away */
+	sched_post(frequency_valid && idle ? EV_DONE | EV_DISPLAY : EV_DONE);
 }
 
-static inline void self_test(void)
+#ifdef AUTO_NOTE
+/* Capture for the string a scan found, or scan again */
+static inline void auto_switch(void)
 {
-	/* Check input from ADC. It should
-	 * have some sensible values */
-	int count;
-	int drop;
-	uint16_t tmp, min, max;
-
-	/* Initialize some memory */
-	for (count = 0; count < FFT_N; count++) {
-		v.fft_buff[count].i = count;
-		v.fft_buff[count].r = 32000 - count;
-	}
-
-	while (tick < 100);
-	cli();
-
-	for (;;) {
-		count = 100;
-		min=32768;
-		max=0;
-		do {
-			drop = 100;
-			do {
-				while( !(ADCSRA & (1<<ADIF)) );
-				ADCSRA |= (1<<ADIF);
-			} while (--drop);
-			tmp = ADC;
-
-			PORTA ^= (1<<PA1); /* Blink IR light */
-
-			if (tmp < min)
-				min = tmp;
-			if (tmp > max)
-				max = tmp;
-		} while(--count);
-
-		if (max < 10 || min > 800) {
-			printf("Self-test failed min/max %d/%d\n", min, max);
-			error(1);
-		} else if (max == min) {
-			printf("Self-test failed min=max=%d\n", min);
-			error(2);
-		} else {
-			break;
+	const uint8_t note = auto_next;
+
+	auto_next = AUTO_STAY;
+	auto_missed = 0;
+	if (note != NOTE_SCAN) {
+		/* Another string: the reading shown is of the last one */
+		if (note != auto_note) {
+			avg_freq_running_time = 0;
+			tick = TICK_IDLE;
 		}
+		auto_note = note;
 	}
-
-	PORTA |= (1<<PA1); /* Disable IR light */
-
-	/* Check if memory still holds it's values */
-	for (count=0; count < FFT_N; count++) {
-		if (v.fft_buff[count].i != count) {
-			for (;;) error(3);
-		}
-		if (v.fft_buff[count].r != 32000 - count) {
-			for (;;) error(3);
-		}
-	}
-
-        sei();
+	capture_note(note);
+	sched_cancel(EV_FRAME_STEPS);
 }
+#endif
 
-static inline void adc_init(void)
+/* Results of the analysis (in v) are done with: send them, start
+ * the next frame without CAPTURE_DOUBLE or the switch of AUTO_NOTE */
+static inline void task_done(void)
 {
-	DDRA = 0x00;
-	PORTA = 0x00;
-
-	ADMUX = 0 | (1<<REFS0);
-//	ADMUX = 3 | (1<<REFS0);
-
-	/* Prescaler = / 128; 16*10^6 / 128 = 125000 */
-	/* Prescaler = / 64; 16*10^6 / 64 = 250000 */
-	/* / 13 cycles -> 19230.769230 Hz */
-	ADCSRA = (1<<ADPS2) | (1<<ADPS1) | (1<<ADPS1) | (1<<ADIE) | (1<<ADATE);
-
-	/*
-	 * 000  /2    001  /2
-	 * 010  /4    011  /8
-	 * 100  /16   101  /32
-	 * 110  /64   111  /128
-	 */
-	ADCSRA |= (1<<ADEN) | (1<<ADSC);
+#ifdef TELEMETRY
+	telemetry_frame();
+#endif
+#ifdef STACK_CHECK
+	stack_check();
+#endif
+#ifdef AUTO_NOTE
+	if (auto_next != AUTO_STAY) {
+		auto_switch();
+		return;
+	}
+#endif
+#ifndef CAPTURE_DOUBLE
+	capture_restart();
+#endif
 }
 
+#ifdef HOST
+int main(int argc, char *argv[])
+#else
 int main(void)
+#endif
 {
+#ifdef HOST
+	host_init(argc, argv);
+#endif
 	serial_init();
 	adc_init();
 
 	button_init();
 
-	_delay_ms(20);
-	_delay_ms(20);
-	_delay_ms(20);
+	/* IR LED off, the sensor check turns it on */
+	ir_init();
+
+	memory_fill();
+
+	/* The sensor check starts with the ADC interrupt and finishes as
+	 * EV_SELFTEST; the display powers up meanwhile */
+	sei();
+	while (tick < LCD_POWER_TICKS) hal_wait();
 
 	lcd_init();
 	lcd_chars();
 	lcd_clear();
 	lcd_print("  Self\n  Test");
+	lcd_flush();
 
-	sei();
-
-	/* Enable output IR */
-	PORTA |= (1<<PA1);
-	DDRA |= (1<<PA1);
+	memory_check();
 
-	self_test();
-
-	/* Enable IR */
-	PORTA &= ~(1<<PA1);
-
-	lcd_clear();
-	lcd_print("Init OK");
-
-	tick = 32000;
-	current_note = NOTE_E2;
+	tick = TICK_IDLE;
+	set_sleep_mode(SLEEP_MODE_IDLE);
+#ifdef AUTO_NOTE
+	note_auto = HAL_START_NOTE == NOTE_SCAN;
+#endif
+	capture_note(HAL_START_NOTE);
 	for (;;) {
-		if (clicked) {
-			current_note++;
-			if (current_note > NOTE_E)
-				current_note = NOTE_E2;
-			
-			clicked = 0;
+		switch (sched_next()) {
+		case EV_SELFTEST:
+			task_selftest();
+			break;
+		case EV_BUTTON:
+			task_button();
+			break;
+		case EV_DONE:
+			task_done();
+			break;
+		case EV_ANALYSE:
+			task_analyse();
+			break;
+		case EV_DISPLAY:
+			PROF(PROF_LCD, lcd_update());
+			break;
+		case EV_FRAME:
+			task_frame();
+			break;
+#ifdef PROFILE
+		case EV_PROFILE:
+			prof_dump();
+			break;
+#endif
 		}
-
-		/* Wait for buffer to fill up */
-		do_capture(current_note);
-
-		fft_execute(v.fft_buff);
-		fft_output(v.fft_buff, spectrum);
-
-		printf("\nNote=%d freq=%s Divisor=%d\n", current_note, 
-		       num2str(notes[current_note].freq),
-		       notes[current_note].divisor);
-		spectrum_analyse();
-
-/*		spectrum_display(); */
 	}
 	return 0;
 }
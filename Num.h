@@ -0,0 +1,44 @@
+/**********************************************************************
+ * avr_tuner - fixed point numbers
+ * License: GPLv3+ (See LICENSE)
+ *
+ * num_t carries bars and Hz with NUM_SHIFT fraction bits. Binary, so
+ * scaling is a shift: a note's freq times a bar position up to FFT_N/2
+ * stays in 32 bits for every FFT_N up to 1024, which leaves bar2hz()
+ * a multiply and a shift. The few ratios the analysis needs have short
+ * quotients and go through num_quot(); num2str() rounds to 1/100 for
+ * the display.
+ **********************************************************************/
+
+#ifndef _NUM_H_
+#define _NUM_H_
+
+typedef int32_t num_t;
+
+#define NUM_SHIFT	7
+#define NUM_ONE		(1L << NUM_SHIFT)
+
+/* Integer and constant (double) to num_t */
+#define int2num(x)	((num_t)(x) << NUM_SHIFT)
+#define NUM(x)		((num_t)((x) * NUM_ONE + 0.5))
+
+/* n / d rounded down, for a quotient under 2^bits (1..31): long
+ * division over the low bits of n only, bits steps where a library
+ * division takes 32 */
+static inline uint32_t num_quot(const uint32_t n, const uint32_t d,
+				uint8_t bits)
+{
+	uint32_t r = n >> bits, q = n << (32 - bits);
+
+	while (bits--) {
+		r = (r << 1) | (q >> 31);
+		q <<= 1;
+		if (r >= d) {
+			r -= d;
+			q |= 1;
+		}
+	}
+	return q;
+}
+
+#endif
@@ -0,0 +1,149 @@
+/**********************************************************************
+ * avr_tuner - sub-bar peak estimators
+ * License: GPLv3+ (See LICENSE)
+ *
+ * estimate_bar() places a maximum of spectrum[] between the bars with
+ * the estimator PEAK_ESTIMATOR in Config.h selects. Each one gets a
+ * pointer to the peak bar and returns its offset in bars, num_t (PEAK_ALL
+ * compiles all of them, for 'make bench'):
+ *
+ *  peak_centroid  - weighted mean of the 7 bars around the peak
+ *  peak_parabolic - parabola through the peak and its neighbours
+ *  peak_gaussian  - the same on log2 of the levels; exact for a Gaussian
+ *                   peak, close to it for the Hamming window's
+ *  peak_jain      - ratio of the larger neighbour to the peak (Jain's
+ *                   method), mapped to the offset through a table made
+ *                   for the Hamming window of fft_input()
+ *
+ * Worst case bias on a clean tone (bars): centroid 0.020, parabolic
+ * 0.067, Gaussian 0.016, Jain 0.001. 'make bench' measures cents and
+ * cycles of each on noisy tones. Quinn's estimators need the complex
+ * bins, which fft_output_band() does not keep. Every ratio has a short
+ * quotient, so none of them divides (num_quot()).
+ **********************************************************************/
+
+#if PEAK_ESTIMATOR == PEAK_PARABOLIC || PEAK_ESTIMATOR == PEAK_GAUSSIAN || \
+	defined(PEAK_ALL)
+/* Rounded n / (2 d), d > 0, at most one bar (a peak at the edge of
+ * harmonic_bar()'s window needn't be above both neighbours) */
+static inline int16_t peak_div(const int32_t n, const int32_t d)
+{
+	const uint32_t m = n < 0 ? -n : n;
+	const int16_t q = m >= (uint32_t)d << (NUM_SHIFT + 1) ? NUM_ONE :
+		num_quot(m + d, 2 * d, NUM_SHIFT + 1);
+
+	return n < 0 ? -q : q;
+}
+#endif
+
+#if PEAK_ESTIMATOR == PEAK_CENTROID || defined(PEAK_ALL)
+static inline int16_t peak_centroid(const uint16_t *s)
+{
+	int32_t sum = 0, moment = 0;
+	int16_t q;
+	int i;
+
+	for (i = -3; i <= 3; i++) {
+		sum += s[i];
+		moment += i * (int32_t)s[i];
+	}
+	if (!sum)
+		return 0;
+
+	/* |moment| <= 3 sum */
+	q = num_quot((moment < 0 ? -moment : moment) << NUM_SHIFT, sum,
+		     NUM_SHIFT + 2);
+	return moment < 0 ? -q : q;
+}
+#endif
+
+#if PEAK_ESTIMATOR == PEAK_PARABOLIC || defined(PEAK_ALL)
+static inline int16_t peak_parabolic(const uint16_t *s)
+{
+	const int32_t a = s[-1], b = s[0], c = s[1];
+	const int32_t d = 2 * b - a - c;
+
+	return d > 0 ? peak_div(NUM_ONE * (c - a), d) : 0;
+}
+#endif
+
+#if PEAK_ESTIMATOR == PEAK_GAUSSIAN || defined(PEAK_ALL)
+/* log2(1 + i/32) in 1/256 */
+static const uint16_t tbl_log2[33] PROGMEM = {
+	0, 11, 22, 33, 44, 54, 63, 73, 82, 92, 100, 109, 118, 126, 134, 142,
+	150, 157, 165, 172, 179, 186, 193, 200, 207, 213, 220, 226, 232, 238,
+	244, 250, 256,
+};
+
+/* log2(x) in 1/256, x > 0 */
+static inline int16_t peak_log2(uint16_t x)
+{
+	int16_t e = 15;
+	uint16_t i, f, a, b;
+
+	while (!(x & 0x8000)) {
+		x <<= 1;
+		e--;
+	}
+	i = (x >> 10) & 31;
+	f = x & 0x3FF;
+	a = pgm_read_word_near(&tbl_log2[i]);
+	b = pgm_read_word_near(&tbl_log2[i + 1]);
+	return e * 256 + a + (((b - a) * f) >> 10);
+}
+
+static inline int16_t peak_gaussian(const uint16_t *s)
+{
+	const int32_t a = peak_log2(s[-1] ? s[-1] : 1);
+	const int32_t b = peak_log2(s[0] ? s[0] : 1);
+	const int32_t c = peak_log2(s[1] ? s[1] : 1);
+	const int32_t d = 2 * b - a - c;
+
+	return d > 0 ? peak_div(NUM_ONE * (c - a), d) : 0;
+}
+#endif
+
+#if PEAK_ESTIMATOR == PEAK_JAIN || defined(PEAK_ALL)
+/* Offset in 1/1024 bar of a tone whose larger neighbour is q/256 of the
+ * peak, Hamming window, for q = 109 (offset 0), 125, ... 269 */
+static const int16_t tbl_jain[11] PROGMEM = {
+	0, 77, 147, 211, 270, 324, 374, 420, 464, 505, 543,
+};
+
+static inline int16_t peak_jain(const uint16_t *s)
+{
+	const uint16_t n = s[1] > s[-1] ? s[1] : s[-1];
+	uint16_t q, i, f;
+	int16_t a, b, off;
+
+	if (!s[0])
+		return 0;
+	/* Clamped below from 269 on anyway */
+	q = n >= 2UL * s[0] ? 511 : num_quot((uint32_t)n << 8, s[0], 9);
+	if (q <= 109)
+		return 0;
+	q -= 109;
+	i = q >> 4;
+	f = q & 15;
+	if (i >= 10) {
+		i = 9;
+		f = 16;
+	}
+	a = pgm_read_word_near(&tbl_jain[i]);
+	b = pgm_read_word_near(&tbl_jain[i + 1]);
+	off = (a + (((b - a) * f) >> 4) + 4) >> (10 - NUM_SHIFT);
+	return s[1] > s[-1] ? off : -off;
+}
+#endif
+
+#if PEAK_ESTIMATOR == PEAK_CENTROID
+#define peak_offset peak_centroid
+#elif PEAK_ESTIMATOR == PEAK_PARABOLIC
+#define peak_offset peak_parabolic
+#elif PEAK_ESTIMATOR == PEAK_GAUSSIAN
+#define peak_offset peak_gaussian
+#elif PEAK_ESTIMATOR == PEAK_JAIN
+#define peak_offset peak_jain
+#else
+#error Unknown PEAK_ESTIMATOR.
+#endif
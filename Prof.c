@@ -0,0 +1,168 @@
+/**********************************************************************
+ * avr_tuner - stage profiler
+ * License: GPLv3+ (See LICENSE)
+ *
+ * With PROFILE in Config.h the stages of a frame and the ADC interrupt
+ * are timed in CPU cycles and any byte received by the UART dumps the
+ * statistics since the last dump as text:
+ *
+ *   profile 16000000 cycles, adc isr 61/1000, first reading at 2400000
+ *   stage    calls     min    mean     max  <512 <1k <2k ... >=512k
+ *
+ * Timer1 already runs at F_CPU as the ADC trigger, counting to OCR1A
+ * and starting over; prof_now() adds TCNT1 to a cycle count the ADC
+ * interrupt moves on by a period every time. A stamp costs about 20
+ * cycles plus the interrupt lock, the bookkeeping afterwards is not
+ * part of the stage. Stages are wall clock, interrupts included; the
+ * ADC interrupt counts from its first statement, without the register
+ * saves around it. Histograms are in octaves of cycles and saturate
+ * at 255. Costs about 200 bytes of SRAM. Device only; the host build
+ * has no Timer1 and ignores PROFILE.
+ **********************************************************************/
+
+#ifdef HOST
+#undef PROFILE
+#endif
+
+#ifdef PROFILE
+
+enum {
+	PROF_CAPTURE,	/* capture_take() */
+	PROF_FFT,	/* fft_execute(), or goertzel_spectrum() */
+	PROF_OUTPUT,	/* fft_output_band() */
+	PROF_ANALYSE,	/* spectrum_analyse() or yin_analyse() */
+	PROF_LCD,	/* lcd_update() */
+	PROF_ADC,	/* ISR(ADC_vect) */
+	PROF_STAGES
+};
+
+/* Histogram: bin 0 below 2^(PROF_BIN0+1) cycles, then an octave each,
+ * the last one open */
+#define PROF_BIN0	8
+#define PROF_BINS	12
+
+static const char prof_names[PROF_STAGES][8] PROGMEM = {
+	"capture", "fft", "output", "analyse", "lcd", "adc isr",
+};
+
+static struct prof_stat {
+	uint32_t calls, min, max, sum;
+	uint8_t hist[PROF_BINS];
+} prof_stat[PROF_STAGES];
+
+/* Cycles up to the last Timer1 period the ADC interrupt counted */
+volatile static uint32_t prof_base;
+
+/* prof_now() of the last dump */
+static uint32_t prof_since;
+
+/* prof_now() of the first reading, counted from adc_init() */
+static uint32_t prof_boot;
+
+/* Cycles since power-on, wrapping every 268 s; main() only */
+static inline uint32_t prof_now(void)
+{
+	uint32_t base;
+	uint16_t t;
+
+	cli();
+	base = prof_base;
+	t = TCNT1;
+	/* Wrapped, the ADC interrupt hasn't counted it yet */
+	if (TIFR & (1<<OCF1A)) {
+		base += OCR1A + 1;
+		t = TCNT1;
+	}
+	sei();
+	return base + t;
+}
+
+static void prof_add(const uint8_t stage, const uint32_t cycles)
+{
+	struct prof_stat *s = &prof_stat[stage];
+	uint32_t c = cycles >> PROF_BIN0;
+	uint8_t bin = 0;
+
+	if (!s->calls || cycles < s->min)
+		s->min = cycles;
+	if (cycles > s->max)
+		s->max = cycles;
+	s->sum += cycles;
+	s->calls++;
+
+	while (c > 1 && bin < PROF_BINS - 1) {
+		c >>= 1;
+		bin++;
+	}
+	if (s->hist[bin] != 0xFF)
+		s->hist[bin]++;
+}
+
+/* Times the statement(s) as stage */
+#define PROF(stage, ...) do {				\
+		const uint32_t prof_t = prof_now();	\
+		__VA_ARGS__;				\
+		prof_add(stage, prof_now() - prof_t);	\
+	} while (0)
+
+/* Around the body of ISR(ADC_vect); it runs well after the wrap of
+ * the period that triggered it and ends long before the next one */
+#define PROF_ISR_BEGIN()	const uint16_t prof_t = TCNT1
+#define PROF_ISR_END()		prof_isr(prof_t)
+
+static inline void prof_isr(const uint16_t start)
+{
+	const uint16_t period = OCR1A + 1;
+
+	prof_add(PROF_ADC, (uint16_t)(TCNT1 - start));
+	if (TIFR & (1<<OCF1A)) {
+		TIFR = (1<<OCF1A);
+		prof_base += period;
+	}
+}
+
+/* Statistics since the last dump to stdout, then start over (EV_PROFILE) */
+static void prof_dump(void)
+{
+	static struct prof_stat s;
+	const uint32_t now = prof_now(), elapsed = now - prof_since;
+	uint8_t i, j;
+
+	/* The interrupt's share is counted while it runs */
+	cli();
+	s = prof_stat[PROF_ADC];
+	memset(&prof_stat[PROF_ADC], 0, sizeof(s));
+	sei();
+
+	fprintf_P(stdout, PSTR("profile %lu cycles, adc isr %lu/1000, "
+			       "first reading at %lu\n"
+			       "stage    calls     min    mean     max "
+			       " <512 <1k <2k <4k <8k <16k <32k <64k"
+			       " <128k <256k <512k >=512k\n"),
+		  elapsed, elapsed >= 1000 ? s.sum / (elapsed / 1000) : 0,
+		  prof_boot);
+
+	for (i = 0; i < PROF_STAGES; i++) {
+		if (i != PROF_ADC) {
+			s = prof_stat[i];
+			memset(&prof_stat[i], 0, sizeof(s));
+		}
+		fprintf_P(stdout, PSTR("%-7S %6lu %7lu %7lu %7lu"),
+			  prof_names[i], s.calls, s.min,
+			  s.calls ? s.sum / s.calls : 0, s.max);
+		for (j = 0; j < PROF_BINS; j++)
+			fprintf_P(stdout, PSTR(" %u"), s.hist[j]);
+		putchar('\n');
+	}
+
+	/* Time spent here isn't any stage's */
+	prof_since = prof_now();
+}
+
+#else
+
+#define PROF(stage, ...)	__VA_ARGS__
+#define PROF_ISR_BEGIN()
+#define PROF_ISR_END()
+
+#endif
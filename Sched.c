@@ -0,0 +1,73 @@
+/**********************************************************************
+ * avr_tuner - event scheduler
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Interrupts post events, main() runs the task of the most
+ * urgent pending one to completion and sleeps while none is. Lower
+ * bits go first, so a button press is served as soon as the running
+ * task returns instead of after a whole capture. A frame is worked
+ * off in steps, each posting the next, which lets the button and the
+ * display in between.
+ **********************************************************************/
+
+enum {
+	EV_SELFTEST	= 1 << 0,	/* Sensor check done (ADC interrupt) */
+	EV_BUTTON	= 1 << 1,	/* Button pressed (ADC interrupt) */
+	EV_DONE		= 1 << 2,	/* Analysis done: telemetry slot */
+	EV_ANALYSE	= 1 << 3,	/* Frame transformed */
+	EV_DISPLAY	= 1 << 4,	/* Redraw due (ADC interrupt) */
+	EV_FRAME	= 1 << 5,	/* Frame or hop captured (ADC interrupt) */
+	EV_PROFILE	= 1 << 6,	/* Byte received (UART interrupt, PROFILE) */
+};
+
+/* Events of the frame in flight, dropped when the note changes */
+#define EV_FRAME_STEPS	(EV_FRAME | EV_ANALYSE | EV_DONE)
+
+/* Pending events; interrupts set bits directly */
+volatile static uint8_t sched_events;
+
+/* Post from main() */
+static inline void sched_post(const uint8_t ev)
+{
+	cli();
+	sched_events |= ev;
+	sei();
+}
+
+/* Drop pending events */
+static inline void sched_cancel(const uint8_t ev)
+{
+	cli();
+	sched_events &= ~ev;
+	sei();
+}
+
+/* Take the most urgent pending event, sleep until there is one */
+static inline uint8_t sched_next(void)
+{
+	uint8_t ev;
+
+	for (;;) {
+		cli();
+		if (sched_events) {
+			/* Lowest set bit */
+			ev = sched_events & -sched_events;
+			sched_events &= ~ev;
+			sei();
+			return ev;
+		}
+#if DEBUG
+		sei();
+		hal_wait();
+#else
+		/* sei() lets one more instruction through before any
+		 * interrupt, so none slips in between the test and the
+		 * sleep. Idle: Timer1 triggers the ADC and Timer0 feeds
+		 * the LCD, neither runs in ADC noise reduction mode */
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+#endif
+	}
+}
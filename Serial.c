@@ -3,18 +3,100 @@
  * License: GPL3+ (See LICENSE)
  *
  * stdio driven hardware UART for debugging.
+ *
+ * Output goes through a ring drained by the UDRE interrupt, so printf
+ * only waits when the ring is full. serial_blocks() sends a list of
+ * buffers in place (Telemetry.c's frames) from the same interrupt,
+ * ahead of the ring, so text never lands inside one.
  ********************/
 const uint16_t UART_BAUDRATE = 16; /* 115200 */
 
+/* Transmit ring, a power of two */
+#define SERIAL_TX	32
+
+static uint8_t serial_tx[SERIAL_TX];
+static volatile uint8_t serial_tx_head, serial_tx_tail;
+
+/* Buffer sent by serial_blocks(), advanced by the interrupt */
+struct serial_block {
+	const uint8_t *p;
+	uint16_t len;
+};
+
+static struct serial_block * volatile serial_blk;
+static volatile uint8_t serial_blk_left;
+
 static FILE serial_stdout;
 
+/* Next byte out: blocks first, then the ring */
+static inline void serial_udre(void)
+{
+	while (serial_blk_left) {
+		if (serial_blk->len) {
+			UDR = *serial_blk->p++;
+			serial_blk->len--;
+			return;
+		}
+		serial_blk++;
+		serial_blk_left--;
+	}
+
+	if (serial_tx_tail != serial_tx_head) {
+		UDR = serial_tx[serial_tx_tail];
+		serial_tx_tail = (serial_tx_tail + 1) & (SERIAL_TX - 1);
+		return;
+	}
+
+	UCSRB &= ~(1<<UDRIE);
+}
+
+ISR(USART_UDRE_vect)
+{
+	serial_udre();
+}
+
 static int serial_putchar(char c, FILE *Stream)
 {
-	while ( !(UCSRA & (1<<UDRE)) );
-	UDR = c;
+	const uint8_t next = (serial_tx_head + 1) & (SERIAL_TX - 1);
+
+	/* Full: wait for the interrupt, or do its work if called with
+	 * interrupts off, so a printf there can't hang */
+	while (next == serial_tx_tail) {
+		if (!(SREG & (1<<SREG_I)) && (UCSRA & (1<<UDRE)))
+			serial_udre();
+	}
+	serial_tx[serial_tx_head] = c;
+	serial_tx_head = next;
+	UCSRB |= (1<<UDRIE);
 	return 0;
 }
 
+#ifdef PROFILE
+/* Any byte received asks for the profile (Prof.c) */
+ISR(USART_RXC_vect)
+{
+	(void)UDR;
+	sched_events |= EV_PROFILE;
+}
+#endif
+
+#ifdef TELEMETRY
+/* The last serial_blocks() are still going out */
+static inline uint8_t serial_sending(void)
+{
+	return serial_blk_left;
+}
+
+/* Send n blocks from the interrupt; blk and what it points to must
+ * stay untouched while serial_sending() */
+static inline void serial_blocks(struct serial_block *blk, const uint8_t n)
+{
+	serial_blk = blk;
+	serial_blk_left = n;
+	UCSRB |= (1<<UDRIE);
+}
+#endif
+
 /*
 static int serial_getchar(FILE *Stream)
 {
@@ -35,6 +117,9 @@ static inline void serial_init(void)
 
 	/* Enable receiver and transmitter */
 	UCSRB = (1<<RXEN) | (1<<TXEN);
+#ifdef PROFILE
+	UCSRB |= (1<<RXCIE);
+#endif
 
 	/* even parity, 8 bits of data, 1 stop bits */
 	UCSRC = (1<<URSEL) | (0<<USBS) | (1<<UCSZ0) | (1<<UCSZ1) | (1<<UPM1);
@@ -45,4 +130,3 @@ static inline void serial_init(void)
 	fdev_setup_stream(&serial_stdout, serial_putchar, NULL, _FDEV_SETUP_RW);
 	stdout = &serial_stdout;
 }
-
@@ -0,0 +1,73 @@
+/**********************************************************************
+ * avr_tuner - stack high-water mark
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Static data, the stack and nothing else (no malloc) share the 2 KB
+ * of SRAM: .data and .bss from the bottom, the stack down from the
+ * top. Before any startup code runs, everything between the end of
+ * .bss and the top is painted with STACK_PAINT. After every frame
+ * stack_check() counts the bytes above .bss the stack has never
+ * reached; below STACK_MARGIN the tuner stops on error 4 ("STACK
+ * ERROR!") before the stack can run into data. 'make' lists what the
+ * static part is made of in Main.sram. Device only, the host build has no such layout.
+ **********************************************************************/
+
+#ifdef HOST
+#undef STACK_CHECK
+#endif
+
+#ifdef STACK_CHECK
+
+#define STACK_PAINT	0xC5
+
+/* End of .bss (and .noinit) and the top of SRAM, from the linker */
+extern uint8_t _end;
+extern uint8_t __stack;
+
+/* Fewest untouched bytes seen */
+static uint16_t stack_low = 0xFFFF;
+
+/* .init1 runs before r1 is cleared and SP is set up, so no C */
+void stack_paint(void) __attribute__((naked, used, section(".init1")));
+void stack_paint(void)
+{
+	__asm__ __volatile__ (
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M" (STACK_PAINT));
+}
+
+/* Bytes above .bss the stack has not reached since power-on */
+static uint16_t stack_free(void)
+{
+	const uint8_t *p = &_end;
+
+	while (p <= &__stack && *p == STACK_PAINT)
+		p++;
+	return p - &_end;
+}
+
+static inline void stack_check(void)
+{
+	const uint16_t free = stack_free();
+
+	if (free >= stack_low)
+		return;
+	stack_low = free;
+	printf("STACK FREE %u\n", free);
+
+	if (free < STACK_MARGIN) {
+		cli();
+		for (;;) error(4);
+	}
+}
+
+#endif
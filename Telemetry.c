@@ -0,0 +1,118 @@
+/**********************************************************************
+ * avr_tuner - binary telemetry
+ * License: GPLv3+ (See LICENSE)
+ *
+ * With TELEMETRY in Config.h every analysed frame leaves the UART as
+ * one binary frame, sent by the UDRE interrupt (Serial.c) while the
+ * next one is captured. 'make teldecode' builds the host decoder
+ * (host/teldecode.c). Little endian:
+ *
+ *   0xA5 0x5A     sync
+ *   id            frame counter; a gap is frames dropped
+ *   note, exp     current_note, spectrum_exp
+ *   flags         bit 0: a frequency was found
+ *   first, count  u16 each: bars of the band (count 0 with PITCH_YIN)
+ *   band          count x u16, spectrum[first..] as analysed
+ *   harmonics     u8 n, then n x {bar u16, freq s32 num_t Hz, level u16}
+ *   avg_freq      s32 num_t Hz, 0 unless found
+ *   check         u8 a, u8 b: b += a += every byte from id on, mod 256
+ *
+ * The band goes out straight from spectrum[], which the next frame
+ * rewrites a hop later; a frame still being sent by then fails its
+ * check. When the previous frame is still being sent, the new one is
+ * dropped. About 130 bytes with FFT_N = 128, 12 ms at 115200 baud.
+ **********************************************************************/
+
+#define TEL_SYNC0	0xA5
+#define TEL_SYNC1	0x5A
+#define TEL_HEAD	10
+#define TEL_TAIL	(1 + 4 * 8 + 4 + 2)
+
+static uint8_t tel_head[TEL_HEAD];
+static uint8_t tel_tail[TEL_TAIL];
+static struct serial_block tel_blocks[3];
+static uint8_t tel_id;
+
+static inline uint8_t *tel_put16(uint8_t *p, const uint16_t x)
+{
+	*p++ = x;
+	*p++ = x >> 8;
+	return p;
+}
+
+static inline uint8_t *tel_put32(uint8_t *p, const uint32_t x)
+{
+	p = tel_put16(p, x);
+	return tel_put16(p, x >> 16);
+}
+
+/* Running sums of the check over n bytes */
+static inline void tel_check(const uint8_t *p, uint16_t n, uint8_t *a, uint8_t *b)
+{
+	while (n--) {
+		*a += *p++;
+		*b += *a;
+	}
+}
+
+/* Frame of the analysis that just ran */
+static inline void telemetry_frame(void)
+{
+#ifdef PITCH_YIN
+	const uint16_t first = 0, count = 0;
+	const uint8_t harm_cnt = 0;
+#else
+	const uint16_t first = SPECTRUM_FIRST, count = SPECTRUM_COUNT;
+	const uint8_t harm_cnt = v(harm_cnt);
+#endif
+	uint8_t *p, a = 0, b = 0;
+#ifndef PITCH_YIN
+	uint8_t i;
+#endif
+
+	if (serial_sending()) {
+		tel_id++;
+		return;
+	}
+
+	p = tel_head;
+	*p++ = TEL_SYNC0;
+	*p++ = TEL_SYNC1;
+	*p++ = tel_id++;
+	*p++ = current_note;
+	*p++ = spectrum_exp;
+	*p++ = frequency_valid;
+	p = tel_put16(p, first);
+	p = tel_put16(p, count);
+
+	p = tel_tail;
+	*p++ = harm_cnt;
+#ifndef PITCH_YIN
+	for (i = 0; i < harm_cnt; i++) {
+		p = tel_put16(p, v(harm_bar)[i]);
+		p = tel_put32(p, v(harm_freq)[i]);
+		p = tel_put16(p, v(harm_wage)[i]);
+	}
+#endif
+	p = tel_put32(p, frequency_valid ? v(avg_freq) : 0);
+
+	tel_check(tel_head + 2, TEL_HEAD - 2, &a, &b);
+#ifndef PITCH_YIN
+	tel_check((const uint8_t *)&spectrum[first], 2 * count, &a, &b);
+#endif
+	tel_check(tel_tail, p - tel_tail, &a, &b);
+	*p++ = a;
+	*p++ = b;
+
+	tel_blocks[0].p = tel_head;
+	tel_blocks[0].len = TEL_HEAD;
+#ifdef PITCH_YIN
+	tel_blocks[1].p = tel_head;
+#else
+	tel_blocks[1].p = (const uint8_t *)&spectrum[first];
+#endif
+	tel_blocks[1].len = 2 * count;
+	tel_blocks[2].p = tel_tail;
+	tel_blocks[2].len = p - tel_tail;
+	serial_blocks(tel_blocks, 3);
+}
@@ -0,0 +1,596 @@
+/**********************************************************************
+ * avr_tuner - notes and spectrum analysis
+ * Copyright (C) 2010 by Tomasz bla Fortuna <bla@thera.be>
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Everything between a filled fft_buff and the LCD: note table, FFT
+ * buffers, peak search, frequency estimation and the display. No
+ * hardware access apart from the LCD, so it is also included by the
+ * simulator benchmark (sim/bench_avr.c).
+ **********************************************************************/
+
+/*
+ * Notes
+ *
+ * Every string is sampled at 4 * f * divisor Hz (NOTE_OCR, the Timer1
+ * compare that starts each conversion) and decimated by divisor, so a
+ * frame of FFT_N samples holds FFT_N/4 periods of f and the note lands
+ * on bar NOTE_BAR = FFT_N/4. The divisors keep the conversion rate
+ * within ~12% of ADC_HZ.
+ */
+
+#include "FFT/ffft.h"
+
+/* No room for the capture ring next to a 512 point frame */
+#if FFT_N > 256
+#undef CAPTURE_DOUBLE
+#endif
+
+/* FFT Buffers and data*/
+#define v(x) v.vars.x
+
+/*** Constants ***/
+const int spectrum_min = 10;
+const int spectrum_max = FFT_N/2 - 10;
+const int harm_max = 4;
+
+/* Notes sit on bar NOTE_BAR; peaks below BAR_LOW are taken as f/2,
+ * from BAR_HIGH on as 3f/2 (25 and 38 with FFT_N = 128) */
+#define NOTE_BAR	(FFT_N / 4)
+#define BAR_LOW		(NOTE_BAR * 25 / 32)
+#define BAR_HIGH	(NOTE_BAR * 38 / 32)
+
+/* num_quot() bits of a bar position below FFT_N/2, up to FFT_N = 1024 */
+#define NUM_BAR_BITS	17
+
+/* Bars spectrum_analyse() reads: spectrum_min..max and 4 around them */
+#define SPECTRUM_FIRST	(spectrum_min - 4)
+#define SPECTRUM_COUNT	(spectrum_max - spectrum_min + 8)
+
+/*** Buffers + Variables ***/
+union {
+	/* Buffer we store captured data in
+	 * inside FFT is calculated and then transposed
+	 * into spectrum */
+	complex_t fft_buff[FFT_BFLY];   /* 2*FFT_N bytes, 4*FFT_N without INPUT_REAL */
+
+	/* After fft_buff is unused we can use it's memory
+	 * to hold variables required during analysis */
+	struct {
+		/* Generic helper for calculating averages */
+		uint16_t avg_helper;
+
+		/* For locating maximas */
+		uint32_t avg_global;
+
+		uint32_t running_avg;
+		char dist_between_max;
+
+		/* Number of harmonics found */
+		int harm_cnt;
+
+		/* Index of the one with biggest wage + it's wage */
+		int harm_main;
+		uint16_t harm_main_wage;
+
+		/* Harmonic sum of the best candidate so far */
+		uint32_t harm_score;
+
+		/* Harmonics found + their wages */
+		num_t harm_freq[4];
+		int16_t harm_bar[4];
+		uint16_t harm_wage[4];
+
+		/* Averaging correct frequency */
+		num_t avg_freq;
+	} vars;
+} v;
+
+/* For function num2str; outside v, the display is drawn between the
+ * steps of a frame (Sched.c) */
+static char num2str_buff[10];
+
+#ifndef PITCH_YIN
+/* Final version of spectrum for analysis */
+uint16_t spectrum[FFT_N/2];  /* FFT_N bytes */
+#endif
+
+/* Block exponent of spectrum[]: the input shift of the frame plus the
+ * FFT stages left unscaled. Levels are 2^spectrum_exp times those of
+ * 16 x the mean ADC deviation through a fixed scale FFT. */
+static uint8_t spectrum_exp;
+
+/* Noise thresholds of spectrum_analyse() at the current exponent, in
+ * quarters of the exponent 0 level (which is where the old fixed
+ * 1000 x gain spectrum / 16 sat, within 3%) */
+#define SPECTRUM_LEVEL(n) (((uint32_t)(n) << spectrum_exp) >> 2)
+
+/* Frames analysed per FFT_N samples; time_relevant is given per FFT_N */
+#if defined(CAPTURE_DOUBLE) && defined(CAPTURE_HOP)
+#define CAPTURE_FRAMES (FFT_N / CAPTURE_HOP)
+#else
+#define CAPTURE_FRAMES 1
+#endif
+
+/* Resulting frequency is averaged further */
+static num_t avg_freq_running;
+
+/* And ignored after some time of no measurements */
+static uint16_t avg_freq_running_time;
+
+/* The last frame analysed went through frequency_found() */
+static uint8_t frequency_valid;
+
+/* Incremented in ADC with every conversion, about ADC_HZ */
+volatile static uint32_t tick;
+
+/* No measurement for this many ticks clears the reading */
+#define TICK_IDLE ((uint32_t)(ADC_HZ * 3.3))
+
+/* Ticks between redraws, and until the next EV_DISPLAY */
+#define LCD_TICKS ((uint16_t)(ADC_HZ / 4))
+volatile static uint16_t lcd_tick = LCD_TICKS;
+
+/*** NOTE data ***/
+
+/* Current selected note (divisor is required
+ * for gathering windowed data) */
+static unsigned int current_note;
+
+/* Gain of the decimator in adc_sample(): 16 / divisor^2, in 1/4096;
+ * 16 x the mean of up to +-1023 still fits into 16 bits */
+#define CIC_GAIN(divisor) ((65536UL + (divisor) * (divisor) / 2) / ((divisor) * (divisor)))
+
+/* ADC rate putting f exactly on bar FFT_N/4 after the decimator */
+#define NOTE_OCR(f, divisor) ADC_OCR(4 * (f) * (divisor))
+
+enum { NOTE_E2 = 0, NOTE_A, NOTE_D, NOTE_G, NOTE_B, NOTE_E, NOTE_SCAN };
+struct {
+	char name;
+	char divisor;
+	uint16_t freq; /* num_t, within 16 bits */
+	int16_t time_relevant; /* Time in which running average of freq is relevant */
+	uint16_t cic_gain;
+	uint16_t ocr; /* adc_rate() */
+} notes[] = {
+	/* f=82.407 div=9 adc=2966.7 Hz */
+	{'E', 9, NUM(82.407), 3, CIC_GAIN(9), NOTE_OCR(82.407, 9)},
+	/* f=110.000 div=7 adc=3080.0 Hz */
+	{'A', 7, NUM(110.0), 3, CIC_GAIN(7), NOTE_OCR(110.0, 7)},
+	/* f=146.832 div=5 adc=2936.6 Hz */
+	{'D', 5, NUM(146.832), 5, CIC_GAIN(5), NOTE_OCR(146.832, 5)},
+	/* f=195.998 div=4 adc=3136.0 Hz */
+	{'G', 4, NUM(195.998), 7, CIC_GAIN(4), NOTE_OCR(195.998, 4)},
+	/* f=246.942 div=3 adc=2963.3 Hz */
+	{'B', 3, NUM(246.942), 8, CIC_GAIN(3), NOTE_OCR(246.942, 3)},
+	/* f=329.628 div=2 adc=2637.0 Hz */
+	{'e', 2, NUM(329.628), 10, CIC_GAIN(2), NOTE_OCR(329.628, 2)},
+#ifdef AUTO_NOTE
+	/* Scan frames of AUTO_NOTE (Auto.c), 1500 Hz after the decimator */
+	/* f=375.000 div=2 adc=3000.0 Hz */
+	{'?', 2, NUM(375.0), 1, CIC_GAIN(2), NOTE_OCR(375.0, 2)},
+#endif
+};
+
+/* Digits of num2str() are counted by subtraction */
+static const uint16_t tbl_pow10[4] PROGMEM = {10000, 1000, 100, 10};
+
+static const char *num2str(num_t number)
+{
+	char *p = num2str_buff, *first;
+	uint16_t whole, frac, pow;
+	char d;
+	int i;
+
+	/* Sign first: -0.50 has no integer part to carry it */
+	if (number < 0) {
+		*p++ = '-';
+		number = -number;
+	}
+	first = p;
+
+	/* Rounded to 1/100, which may carry into the integer part */
+	frac = ((uint16_t)(number & (NUM_ONE - 1)) * 100 + NUM_ONE / 2) >> NUM_SHIFT;
+	whole = number >> NUM_SHIFT;
+	if (frac == 100) {
+		frac = 0;
+		whole++;
+	}
+
+	for (i = 0; i < 4; i++) {
+		pow = pgm_read_word_near(&tbl_pow10[i]);
+		for (d = '0'; whole >= pow; d++)
+			whole -= pow;
+		if (d != '0' || p != first)
+			*p++ = d;
+	}
+	*p++ = '0' + whole;
+	*p++ = '.';
+	for (d = '0'; frac >= 10; d++)
+		frac -= 10;
+	*p++ = d;
+	*p++ = '0' + frac;
+	*p = '\0';
+
+	return num2str_buff;
+}
+
+/* Convert accurate bar position into frequency; the note's ADC rate
+ * puts its freq on bar NOTE_BAR, a power of two, so this is a shift */
+static inline num_t bar2hz(const num_t bar)
+{
+	return ((uint32_t)notes[current_note].freq * bar) / ((uint32_t)NOTE_BAR << NUM_SHIFT);
+}
+
+/* Redraw, every LCD_TICKS (EV_DISPLAY) */
+static inline void lcd_update(void)
+{
+	/* Steps of 1/3 Hz, 20 is in tune; rounded towards 0 */
+	const num_t diff = avg_freq_running - notes[current_note].freq;
+	const int32_t error = 20 +
+		(diff < 0 ? -((-diff * 3) >> NUM_SHIFT) : (diff * 3) >> NUM_SHIFT);
+	uint8_t pos = 0, cell;
+
+#ifdef AUTO_NOTE
+	/* Scanning: the last reading stays up until it times out */
+	if (current_note == NOTE_SCAN && tick < TICK_IDLE)
+		return;
+#endif
+
+	lcd_clear();
+
+	if (tick >= TICK_IDLE) {
+		lcd_print("-- \x07\x06 --");
+		tick = TICK_IDLE;
+	} else {
+		/* Code error in range 0 30 - 15 meaning no error */
+		if (error <= 0) {
+			lcd_print("<");
+		} else if (error > 40) {
+			lcd_print("       >");
+		} else {
+			/* error-1 is 5 * pos + cell */
+			for (cell = error - 1; cell >= 5; cell -= 5)
+				pos++;
+			lcd_goto(pos, 0);
+			lcd_send(1 + cell);
+		}
+
+		/* Mark center */
+		if (pos == 3) {
+			lcd_goto(4, 0);
+			lcd_send(6);
+		} else {
+			lcd_goto(3, 0);
+			lcd_send(7);
+		}
+	}
+
+	lcd_goto(0, 1);
+	lcd_send(notes[current_note].name);
+
+	if (tick >= TICK_IDLE) {
+		lcd_goto(2, 1);
+		lcd_print("SZARP!");
+	} else { 
+		/* 01234567
+		 * N_123.34  LEN=6, 8-LEN
+		 */
+		const char *freq = num2str(avg_freq_running - notes[current_note].freq);
+		lcd_goto(8 - strlen(freq), 1);
+		lcd_print(freq);
+	}
+
+	lcd_flush();
+}
+
+/* A frame found v(avg_freq): into the running average, which the
+ * display shows */
+static inline void frequency_found(void)
+{
+	if (avg_freq_running_time) {
+		avg_freq_running += v(avg_freq);
+		avg_freq_running /= 2;
+	} else {
+		avg_freq_running = v(avg_freq);
+	}
+
+	avg_freq_running_time = notes[current_note].time_relevant * CAPTURE_FRAMES;
+	frequency_valid = 1;
+
+	printf("FREQUENCY         =%s\n", num2str(v(avg_freq)));
+	printf("RUNNING FREQUENCY =%s\n", num2str(avg_freq_running));
+
+	if (notes[current_note].freq < avg_freq_running - int2num(1)) {
+		printf("TOO HIGH\n");
+	} else if (notes[current_note].freq > avg_freq_running + int2num(1)) {
+		printf("TOO LOW\n");
+	} else {
+		printf("TUNED\n");
+	}
+
+	/* Count time to next correct measurement */
+	tick = 0;
+}
+
+#ifndef PITCH_YIN
+/* x / 3, exact, for any x (Hacker's Delight divu3) */
+static inline uint32_t num_div3(const uint32_t x)
+{
+	uint32_t q, r;
+
+	q = (x >> 2) + (x >> 4);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	r = x - q * 3;
+	return q + ((11 * r) >> 5);
+}
+
+/* Method: Calculating frequency; Peak.c places it between the bars */
+static inline num_t estimate_bar(const int16_t bar)
+{
+	uint32_t avg_sum = 0;
+	int i;
+
+	for (i = bar - 3; i <= bar + 3; i++)
+		avg_sum += spectrum[i];
+
+	/* Rounded down neighborhood average + level 5 above the bar,
+	 * all times 7 */
+	if (avg_sum + 7 * SPECTRUM_LEVEL(5) >= 7 * ((uint32_t)spectrum[bar] + 1))
+		return 0;
+	else
+		return int2num(bar) + peak_offset(&spectrum[bar]);
+}
+
+#ifndef ANALYSE_PEAKS
+/* Bar of harmonic k of a fundamental near bar, the highest one within
+ * k/2 bars of k*bar (where the fundamental's own rounding leaves it) */
+static inline int16_t harmonic_bar(const int16_t bar, const int k)
+{
+	const int16_t centre = k * bar;
+	int16_t i, max = centre;
+
+	for (i = centre - k / 2; i <= centre + k / 2; i++)
+		if (spectrum[i] > spectrum[max])
+			max = i;
+	return max;
+}
+
+/* Level of a bar above the spectrum's average, 0 below it */
+static inline uint16_t harmonic_level(const int16_t bar)
+{
+	return spectrum[bar] > v(avg_global) ? spectrum[bar] - v(avg_global) : 0;
+}
+
+#ifdef SPECTRUM_GOERTZEL
+/* Bars goertzel_spectrum() leaves enough of for a candidate: its peak
+ * test looks 2 bars to each side */
+static inline uint8_t goertzel_candidate(const int16_t bar)
+{
+	const int16_t d = GOERTZEL_SPAN - 2;
+
+	return bar >= FFT_N / 8 - d && bar <= 3 * FFT_N / 8 + d &&
+		(bar + d) % (FFT_N / 8) <= 2 * d;
+}
+#endif
+
+/* Method: harmonic sum. Every peak above the average is a candidate
+ * fundamental and scores its own level plus those of its harmonics
+ * within the band, each capped at its own (so a noise bar an octave
+ * below a real peak doesn't win). The harmonics of the best one are
+ * placed by estimate_bar() and averaged, weighted by level. */
+static inline uint8_t harmonic_sum(void)
+{
+	int i, k;
+	uint16_t s, level;
+	uint32_t score, sum, weight;
+
+	v(harm_score) = 0;
+	v(harm_main) = -1;
+	v(harm_cnt) = 0;
+
+	for (i = spectrum_min; i < spectrum_max; i++) {
+#ifdef SPECTRUM_GOERTZEL
+		/* The rest of spectrum[] is 0 */
+		if (!goertzel_candidate(i))
+			continue;
+#endif
+		s = spectrum[i];
+
+		if (s <= v(avg_global) ||
+		    s < spectrum[i - 2] || s < spectrum[i - 1] ||
+		    s < spectrum[i + 1] || s < spectrum[i + 2])
+			continue;
+
+		level = harmonic_level(i);
+		score = level;
+		for (k = 2; k <= harm_max && k * i + k / 2 <= spectrum_max; k++) {
+			const uint16_t h = harmonic_level(harmonic_bar(i, k));
+			score += h < level ? h : level;
+		}
+
+		if (score > v(harm_score)) {
+			v(harm_score) = score;
+			v(harm_main) = i;
+		}
+	}
+
+	if (v(harm_main) < 0)
+		return 0;
+
+	/* Weights >> 2 keep 4 harmonics of up to 512.00 bars in 32 bits */
+	sum = weight = 0;
+	for (k = 1; k <= harm_max && k * v(harm_main) + k / 2 <= spectrum_max; k++) {
+		const int16_t bar = harmonic_bar(v(harm_main), k);
+		const num_t real_bar = estimate_bar(bar);
+		const uint16_t w = harmonic_level(bar) >> 2;
+
+		if (real_bar == 0 || w == 0)
+			continue;
+		v(harm_bar)[v(harm_cnt)] = bar;
+		v(harm_freq)[v(harm_cnt)] = bar2hz(real_bar);
+		v(harm_wage)[v(harm_cnt)] = spectrum[bar];
+		v(harm_cnt)++;
+		printf("Bar=%d / %s ", bar, num2str(real_bar));
+		printf("FREQ=%s Value=%u (avg=%lu, exp=%d)\n", num2str(bar2hz(real_bar)),
+		       spectrum[bar], (unsigned long)v(avg_global), spectrum_exp);
+
+		/* real_bar / k, k up to 4 */
+		sum += (uint32_t)w * (k == 3 ? num_div3(real_bar) : real_bar >> (k >> 1));
+		weight += w;
+	}
+
+	if (weight == 0)
+		return 0;
+	v(avg_freq) = bar2hz(num_quot(sum, weight, NUM_BAR_BITS));
+	return 1;
+}
+#endif
+
+static inline void spectrum_analyse(void)
+{
+	/* The selected note sits on NOTE_BAR, its octave at 2*NOTE_BAR is
+	 * just past the band; another string's fundamental can be anywhere
+	 * in it with its harmonics above */
+	int i;
+	uint16_t s;
+
+	frequency_valid = 0;
+	v(avg_global) = v(avg_helper) = 0;
+
+	/* Precalculations:
+	 * 1) Calculate global maximum for reference and it's position
+	 * 2) Calculate average value for spectrum
+	 */
+	for (i = spectrum_min; i < spectrum_max; i++) {
+		/* Filter out rubbish */
+		s = spectrum[i];
+
+		if (s < SPECTRUM_LEVEL(4))
+			continue;
+
+		/* Avg */
+		v(avg_global) += s;
+		v(avg_helper) += 1;
+	}
+
+	v(avg_global) = v(avg_helper) ? num_quot(v(avg_global), v(avg_helper), 16) : 0;
+
+#ifndef ANALYSE_PEAKS
+	/* Count time for running freq so we will forget it after while */
+	if (avg_freq_running_time)
+		avg_freq_running_time--;
+
+	if (!harmonic_sum())
+		return;
+#else
+	int m;
+
+	/* Calculate positions of all harmonics */
+	v(harm_main_wage) = 0;
+	v(harm_main) = -1;
+	v(harm_cnt) = 0;
+
+	v(running_avg) = 0;
+	v(dist_between_max) = 0;
+
+	for (i = spectrum_min; i<spectrum_max; i++) {
+		s = spectrum[i];
+
+		if (v(dist_between_max)) {
+			v(dist_between_max)--;
+			goto not_max;
+		}
+
+		if (s <= v(running_avg) + SPECTRUM_LEVEL(2))
+			goto not_max;
+
+		for (m=i-4; m <= i+4; m++) {
+			if (s < spectrum[m])
+				goto not_max;
+		}
+
+		if (s <= v(avg_global))
+			goto not_max;
+
+		const num_t real_bar = estimate_bar(i);
+		if (real_bar != 0) {
+			const num_t freq = bar2hz(real_bar);
+			printf("Bar=%d / %s ", i, num2str(real_bar));
+			printf("FREQ=%s Value=%u (avg=%lu, exp=%d)\n", num2str(freq), spectrum[i],
+			       (unsigned long)v(avg_global), spectrum_exp);
+
+			if (s > v(harm_main_wage)) {
+				/* Update main harmonic */
+				v(harm_main_wage) = s;
+				v(harm_main) = v(harm_cnt);
+			}
+
+			v(harm_freq)[v(harm_cnt)] = freq;
+			v(harm_bar)[v(harm_cnt)] = i;
+			v(harm_wage)[v(harm_cnt)] = s;
+
+			v(harm_cnt)++;
+
+			if (v(harm_cnt) == harm_max)
+				break;
+
+			/* Keep distance between maxes */
+			v(dist_between_max) = 4;
+		}
+
+	not_max:
+		v(running_avg) += s;
+		v(running_avg) /= 2;
+	}
+
+	/* Count time for running freq so we will forget it after while */
+	if (avg_freq_running_time)
+		avg_freq_running_time--;
+
+	/* if there're 3 harmonics visible */
+	switch (v(harm_cnt)) {
+	case 3:
+		/* Do the average of all of them treating them sequentially */
+		v(avg_freq) = v(harm_freq)[1];
+		v(avg_freq) += v(harm_freq)[0] * 2;
+		v(avg_freq) += num_div3(v(harm_freq)[2] * 2);
+		v(avg_freq) = num_div3(v(avg_freq));
+		break;
+
+	case 2:
+		if (v(harm_bar)[0] < BAR_LOW) {
+			v(avg_freq) = v(harm_freq)[0] * 2;
+			if (v(harm_bar)[1] < BAR_HIGH)
+				v(avg_freq) += v(harm_freq)[1];
+			else
+				v(avg_freq) += num_div3(v(harm_freq)[1] * 2);
+		} else if (v(harm_bar)[0] < BAR_HIGH) {
+			v(avg_freq) = v(harm_freq)[0];
+			v(avg_freq) += num_div3(v(harm_freq)[1] * 2);
+		} else {
+			/* Ok, something is wrong! */
+			printf("ERR:Something wrong (%d)\n", v(harm_bar)[0]);
+			return;
+		}
+
+		v(avg_freq) /= 2;
+		break;
+	case 1:
+		/* Lone fundamental, nothing folded next to it */
+		if (v(harm_bar)[0] >= BAR_LOW && v(harm_bar)[0] < BAR_HIGH) {
+			v(avg_freq) = v(harm_freq)[0];
+			break;
+		}
+		/* Fall through */
+	default:
+		return;
+	}
+#endif
+
+	frequency_found();
+}
+
+#endif
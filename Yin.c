@@ -0,0 +1,187 @@
+/**********************************************************************
+ * avr_tuner - YIN pitch engine
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Selected with PITCH_YIN in Config.h instead of the FFT and
+ * spectrum_analyse(). capture_take() leaves the raw frame in fft_buff
+ * and the period is found in the time domain:
+ *
+ *  1. d(tau), the squared difference of the frame and itself tau
+ *     samples later, for the periods of bars spectrum_min..max
+ *     (FFT_N / bar samples; the selected note is 4), normalised by its
+ *     running mean; the first dip under YIN_THRESHOLD is the period.
+ *  2. The dip m periods later is measured again, for m up to what fits
+ *     into the longest lag, which divides the interpolation error by
+ *     m. m grows at most 4 times per step, so each estimate is well
+ *     within half a period of the next dip.
+ *
+ * Both steps place the minimum between lags for the dip of a sine,
+ * 1 - cos(pi/2 x) at 4 samples per period. Integer only, ratios go
+ * through num_quot(); every d() costs FFT_N/2 multiplies. The result
+ * goes through frequency_found() like the FFT's.
+ **********************************************************************/
+
+#ifndef YIN_THRESHOLD
+#define YIN_THRESHOLD	12	/* Normalised dip, in 1/64 */
+#endif
+
+/* Terms of every d(); the frame holds them for lags up to FFT_N/2 */
+#define YIN_W		(FFT_N / 2)
+
+/* Periods of step 1, from the Nyquist limit to bar spectrum_min */
+#define YIN_TAU_MIN	2
+#define YIN_TAU_MAX	(FFT_N / spectrum_min + 1)
+
+/* Longest lag of step 2; also keeps FFT_N * NUM_ONE * m * 256 in 32 bits */
+#define YIN_LAG_MAX	(FFT_N / 2 - 2 < 126 ? FFT_N / 2 - 2 : 126)
+
+/* d() >> YIN_SCALE times a lag and YIN_THRESHOLD stays in 32 bits */
+#define YIN_SCALE	14
+
+/* Frame of yin_input(), |x| < 1024 so every d() fits 32 bits */
+#define yin_frame ((int16_t *)v.fft_buff)
+
+/* 2/pi atan(i/8) in 1/256 */
+static const uint8_t tbl_yin_atan[9] PROGMEM = {
+	0, 20, 40, 58, 76, 91, 105, 117, 128,
+};
+
+/* Raw frame, oldest sample at start of the ring src, shifted like
+ * fft_input() would and brought down to 10 bits */
+static inline void yin_input(const int16_t *src, const uint16_t start,
+			     const uint8_t shift)
+{
+	uint16_t i;
+
+	for (i = 0; i < FFT_N; i++)
+		yin_frame[i] = (int16_t)(src[(start + i) & (FFT_N - 1)] << shift) >> 5;
+}
+
+static uint32_t yin_diff(const uint16_t lag)
+{
+	const int16_t *a = yin_frame, *b = yin_frame + lag;
+	uint32_t sum = 0;
+	uint16_t i;
+
+	for (i = 0; i < YIN_W; i++) {
+		const int16_t d = a[i] - b[i];
+		sum += (int32_t)d * d;
+	}
+	return sum;
+}
+
+/* Position of the minimum b between a and c (b <= a, c), in 1/256 lag */
+static int16_t yin_offset(uint32_t a, const uint32_t b, uint32_t c)
+{
+	uint32_t den = a + c - 2 * b, diff;
+	uint16_t q, i, f, lo, hi, off;
+
+	a -= b;
+	c -= b;
+	while (den >= 0x1000000) {
+		den >>= 1;
+		a >>= 1;
+		c >>= 1;
+	}
+	if (!den)
+		return 0;
+
+	/* |a - c| / den in 1/64, at most 1 */
+	diff = a > c ? a - c : c - a;
+	q = diff >= den ? 64 : num_quot(diff << 6, den, 6);
+	i = q >> 3;
+	f = q & 7;
+	if (i >= 8) {
+		i = 7;
+		f = 8;
+	}
+	lo = pgm_read_byte_near(&tbl_yin_atan[i]);
+	hi = pgm_read_byte_near(&tbl_yin_atan[i + 1]);
+	off = lo + (((hi - lo) * f + 4) >> 3);
+	return a > c ? off : -off;
+}
+
+/* Bottom of the dip of d() nearest to lag, in 1/256 lag */
+static uint16_t yin_dip(uint16_t lag)
+{
+	uint32_t a = yin_diff(lag - 1), b = yin_diff(lag), c = yin_diff(lag + 1);
+
+	while (a < b && lag > 2) {
+		c = b;
+		b = a;
+		a = yin_diff(--lag - 1);
+	}
+	while (c < b && lag < FFT_N / 2 - 1) {
+		a = b;
+		b = c;
+		c = yin_diff(++lag + 1);
+	}
+	return (lag << 8) + yin_offset(a, b, c);
+}
+
+/* Sets v(avg_freq), 0 when the frame has no period in range */
+static inline uint8_t yin_pitch(void)
+{
+	uint32_t a = 0, b = 0, c, cum = 0;
+	uint16_t tau = 0, m, k, span;
+	num_t real_bar;
+
+	/* 1. First dip of d(tau) * tau / sum d(1..tau) under the threshold,
+	 * then down to its bottom. One that only came within twice the
+	 * threshold before it (a decaying string's, behind a multiple of
+	 * its period) leaves the frame undecided. */
+	do {
+		if (++tau > YIN_TAU_MAX)
+			return 0;
+		c = a;
+		a = b;
+		b = yin_diff(tau);
+		if (tau > YIN_TAU_MIN && a < c && a <= b &&
+		    (a >> YIN_SCALE) * (tau - 1) * 64 < 2UL * YIN_THRESHOLD * cum)
+			return 0;
+		cum += b >> YIN_SCALE;
+	} while (tau < YIN_TAU_MIN ||
+		 (b >> YIN_SCALE) * tau * 64 >= (uint32_t)YIN_THRESHOLD * cum);
+
+	c = yin_diff(tau + 1);
+	while (c < b) {
+		if (++tau > YIN_TAU_MAX)
+			return 0;
+		a = b;
+		b = c;
+		c = yin_diff(tau + 1);
+	}
+	span = (tau << 8) + yin_offset(a, b, c);
+
+	/* 2. span is m periods, in 1/256 sample */
+	for (m = 1; ; m = k) {
+		/* Periods are 1.5 samples or more, k < 256 */
+		k = num_quot((uint32_t)YIN_LAG_MAX * m << 8, span, 8);
+		if (k <= m)
+			break;
+		if (k > 4 * m)
+			k = 4 * m;
+		span = yin_dip((num_quot((uint32_t)span * k, m, 15) + 128) >> 8);
+	}
+
+	/* FFT_N / (span / m) bars; fft_buff is free from here on */
+	real_bar = num_quot((uint32_t)FFT_N * NUM_ONE * m << 8, span, NUM_BAR_BITS);
+	printf("YIN tau=%d m=%d span=%u bar=%s (exp=%d)\n", tau, m, span, num2str(real_bar), spectrum_exp);
+	if (real_bar < int2num(spectrum_min) || real_bar >= int2num(spectrum_max))
+		return 0;
+
+	v(avg_freq) = bar2hz(real_bar);
+	return 1;
+}
+
+static inline void yin_analyse(void)
+{
+	frequency_valid = 0;
+
+	/* Count time for running freq so we will forget it after while */
+	if (avg_freq_running_time)
+		avg_freq_running_time--;
+
+	if (yin_pitch())
+		frequency_found();
+}
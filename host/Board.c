@@ -0,0 +1,246 @@
+/***********************************
+ * avr_tuner - host board
+ * License: GPL3+ (See LICENSE)
+ *
+ * Sample source reading a WAV or raw PCM recording, resampled to the
+ * rate set with adc_rate() and scaled into 10-bit ADC counts around
+ * 512; with the IR LED off it reads a steady 512. The button is pressed
+ * at the times given with -b. The UART's telemetry frames go into the
+ * file given with -t.
+ ********************/
+
+/* Sample handler in Main.c, gets ADC - 0..1023 */
+static void adc_sample(const int16_t adc);
+
+#include <errno.h>
+
+static struct {
+	/* Whole input, mono, signed 16 bit */
+	int16_t *pcm;
+	long len;
+	double rate;
+
+	/* Position in the input, in input samples */
+	double pos;
+
+	/* ADC counts corresponding to a full-scale input */
+	int amplitude;
+
+	/* Current conversion rate */
+	double adc_hz;
+
+	/* Sample clock, in seconds */
+	double now;
+
+	/* Button press times, in seconds */
+	double press[16];
+	int press_cnt;
+
+	/* Telemetry stream (TELEMETRY in Config.h), or NULL */
+	FILE *telemetry;
+
+	/* IR LED on; off, the sensor sees steady ambient light only */
+	int ir;
+} host = {
+	.amplitude = 32,
+	.adc_hz = ADC_HZ,
+};
+
+#define HOST_PRESS_LEN 0.1
+
+void button_init(void)
+{
+}
+
+char button_clicked(void)
+{
+	int i;
+	for (i = 0; i < host.press_cnt; i++)
+		if (host.now >= host.press[i] && host.now < host.press[i] + HOST_PRESS_LEN)
+			return 1;
+	return 0;
+}
+
+static inline void ir_init(void) { }
+static inline void ir_on(void) { host.ir = 1; }
+static inline void ir_off(void) { host.ir = 0; }
+
+static inline void adc_rate(const uint16_t ocr)
+{
+	host.adc_hz = (double)F_CPU / (ocr + 1);
+}
+
+static inline void adc_init(void)
+{
+	adc_rate(ADC_OCR(ADC_HZ));
+}
+
+/* Next conversion, or the end of the run when input is exhausted */
+static uint16_t host_adc(void)
+{
+	long i;
+	double frac, s;
+	int32_t adc;
+
+	i = (long)host.pos;
+	if (i + 1 >= host.len) {
+		fflush(stdout);
+		exit(0);
+	}
+
+	/* Linear interpolation between input samples */
+	frac = host.pos - i;
+	s = host.pcm[i] + frac * (host.pcm[i + 1] - host.pcm[i]);
+	host.pos += host.rate / host.adc_hz;
+	host.now += 1 / host.adc_hz;
+
+	adc = 512 + (host.ir ? (int32_t)(s * host.amplitude / 32768.0) : 0);
+	if (adc < 0)
+		adc = 0;
+	if (adc > 1023)
+		adc = 1023;
+	return adc;
+}
+
+static void host_pump(void)
+{
+	const uint16_t adc = host_adc();
+	if (host_irq)
+		adc_sample(adc);
+}
+
+/* Seconds of input consumed so far */
+static inline double host_time(void)
+{
+	return host.now;
+}
+
+static uint32_t host_le(const uint8_t *p, int bytes)
+{
+	uint32_t v = 0;
+	while (bytes--)
+		v = (v << 8) | p[bytes];
+	return v;
+}
+
+/* Loads RIFF/WAVE (8/16-bit PCM, first channel used) or headerless
+ * signed 16-bit little-endian mono PCM at host.rate */
+static void host_load(const char *path)
+{
+	FILE *f;
+	uint8_t *buf;
+	long size, off, data = -1, data_len = 0;
+	int channels = 1, bits = 16;
+	long i;
+
+	f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "%s: %s\n", path, strerror(errno));
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	buf = malloc(size + 1);
+	if (!buf || fread(buf, 1, size, f) != (size_t)size) {
+		fprintf(stderr, "%s: read error\n", path);
+		exit(1);
+	}
+	fclose(f);
+
+	if (size >= 12 && !memcmp(buf, "RIFF", 4) && !memcmp(buf + 8, "WAVE", 4)) {
+		/* Chunks are padded to even sizes */
+		for (off = 12; off + 8 <= size;
+		     off += 8 + ((host_le(buf + off + 4, 4) + 1) & ~1UL)) {
+			const uint32_t len = host_le(buf + off + 4, 4);
+			if (!memcmp(buf + off, "fmt ", 4) && len >= 16) {
+				if (host_le(buf + off + 8, 2) != 1) {
+					fprintf(stderr, "%s: only PCM WAV is supported\n", path);
+					exit(1);
+				}
+				channels = host_le(buf + off + 10, 2);
+				host.rate = host_le(buf + off + 12, 4);
+				bits = host_le(buf + off + 22, 2);
+			} else if (!memcmp(buf + off, "data", 4)) {
+				data = off + 8;
+				data_len = len;
+				if (data + data_len > size)
+					data_len = size - data;
+				break;
+			}
+		}
+		if (data < 0 || (bits != 8 && bits != 16) || channels < 1) {
+			fprintf(stderr, "%s: unsupported WAV layout\n", path);
+			exit(1);
+		}
+	} else {
+		data = 0;
+		data_len = size;
+	}
+
+	host.len = data_len / (bits / 8) / channels;
+	host.pcm = malloc(sizeof(*host.pcm) * (host.len + 1));
+	for (i = 0; i < host.len; i++) {
+		const uint8_t *p = buf + data + i * (bits / 8) * channels;
+		if (bits == 8)
+			host.pcm[i] = ((int16_t)p[0] - 128) * 256;
+		else
+			host.pcm[i] = (int16_t)host_le(p, 2);
+	}
+	free(buf);
+}
+
+/* NOTE_E, or NOTE_SCAN for auto (Tuner.c comes later) */
+#ifdef AUTO_NOTE
+#define HOST_NOTE_MAX	6
+#else
+#define HOST_NOTE_MAX	5
+#endif
+
+static void host_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [-n note] [-r rate] [-a amplitude] [-b sec,...] [-t out] file\n"
+		"  file   WAV (PCM) or raw signed 16-bit LE mono recording\n"
+		"  -n     note selected after power-on, 0 (E2) .. 5 (E), 6 auto\n"
+		"  -r     sample rate of a raw file (default: %.1f Hz)\n"
+		"  -a     ADC counts of a full-scale input (default: %d)\n"
+		"  -b     times at which the button is pressed\n"
+		"  -t     file for the telemetry frames (TELEMETRY builds)\n",
+		name, ADC_HZ, host.amplitude);
+	exit(1);
+}
+
+static void host_init(int argc, char *argv[])
+{
+	int i;
+	char *p;
+
+	host.rate = ADC_HZ;
+	for (i = 1; i < argc - 1 && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-n"))
+			host_start_note = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-r"))
+			host.rate = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-a"))
+			host.amplitude = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-b")) {
+			for (p = argv[++i]; *p && host.press_cnt < 16; p++) {
+				host.press[host.press_cnt++] = strtod(p, &p);
+				if (*p != ',')
+					break;
+			}
+		} else if (!strcmp(argv[i], "-t")) {
+			host.telemetry = fopen(argv[++i], "wb");
+			if (!host.telemetry) {
+				perror(argv[i]);
+				exit(1);
+			}
+		} else
+			host_usage(argv[0]);
+	}
+	if (i != argc - 1 || host_start_note > HOST_NOTE_MAX || host.rate <= 0)
+		host_usage(argv[0]);
+
+	host_load(argv[i]);
+}
@@ -0,0 +1,43 @@
+/**********************************************************************
+ * avr_tuner - host (Linux) replacements for avr-libc
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Just enough of <avr/...> for Main.c to compile natively. There are no
+ * real interrupts: "sleeping" or busy-waiting pumps the next sample of
+ * the input file through adc_sample(), which is exactly what the ADC
+ * interrupt does on the device.
+ **********************************************************************/
+
+#ifndef _HOST_HAL_H_
+#define _HOST_HAL_H_
+
+/* Feeds one sample from the input file through the ADC "interrupt" */
+static void host_pump(void);
+
+/* Interrupt flag; host_pump() only calls adc_sample() when it is set */
+static char host_irq;
+
+#define ISR(vector) static void vector(void)
+#define cli() (host_irq = 0)
+#define sei() (host_irq = 1)
+
+#define SLEEP_MODE_IDLE 1
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu() host_pump()
+#define hal_wait() host_pump()
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_word_near(addr) (*(const int16_t *)(addr))
+#define pgm_read_byte_near(addr) (*(const uint8_t *)(addr))
+
+#define _delay_ms(x)
+#define _delay_us(x)
+
+/* Note selected after power-on (-n option) */
+static unsigned int host_start_note;
+#define HAL_START_NOTE host_start_note
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * avr_tuner - host display sink
+ * License: GPLv3+ (See LICENSE)
+ *
+ * Same interface as LCD.c, but the bytes go into a small model of the
+ * HD44780 (DDRAM, CGRAM, address counter) instead of the port pins.
+ * Writes go into the same framebuffer; lcd_flush() sends the changed
+ * cells straight away (no queue, no time passes) and prints the
+ * visible 8x2 window as one text line whenever it changed:
+ *
+ *     12.345 |   2]   |E  -1.23|
+ *
+ * Custom characters are shown as the digit 1-5 (needle column) and
+ * '[' / ']' (center marks), or '?' if CGRAM was never loaded.
+ */
+
+#define lcd_display_on	1
+#define lcd_display_off	0
+
+#define LCD_COLS	8
+#define LCD_ROWS	2
+
+/* Private */
+uint8_t LCDx, LCDy;
+
+/* Next screen, and what the model got from lcd_flush() */
+static uint8_t lcd_fb[LCD_ROWS][LCD_COLS];
+static uint8_t lcd_shown[LCD_ROWS][LCD_COLS];
+
+static struct {
+	char rs;		/* 0 - instruction, 1 - data */
+	char cgram_mode;	/* Data goes to CGRAM instead of DDRAM */
+	uint8_t addr;
+	uint8_t ddram[128];
+	uint8_t cgram[64];
+	char shown[LCD_ROWS][LCD_COLS + 1];
+} hd;
+
+/* Lowlevel function sending byte to LCD controller */
+static void lcd_write(const uint8_t byte)
+{
+	if (hd.rs) {
+		if (hd.cgram_mode)
+			hd.cgram[hd.addr++ & 0x3F] = byte;
+		else
+			hd.ddram[hd.addr++ & 0x7F] = byte;
+		return;
+	}
+
+	if (byte & 0x80) {
+		hd.cgram_mode = 0;
+		hd.addr = byte & 0x7F;
+	} else if (byte & 0x40) {
+		hd.cgram_mode = 1;
+		hd.addr = byte & 0x3F;
+	} else if (byte == 0x01) {
+		memset(hd.ddram, ' ', sizeof(hd.ddram));
+		hd.cgram_mode = 0;
+		hd.addr = 0;
+	}
+}
+
+/* Public */
+/* Function initializing LCD */
+static inline void lcd_init()
+{
+	hd.rs = 0;
+	lcd_write(0x01);
+	LCDx = 0; LCDy = 0;
+	memset(lcd_fb, ' ', sizeof(lcd_fb));
+	memset(lcd_shown, ' ', sizeof(lcd_shown));
+	hd.rs = 1;
+}
+
+/* Goto XY location */
+void lcd_goto(uint8_t x, uint8_t y)
+{
+	LCDx = x; LCDy = y;
+}
+
+/* Clears LCD and goes to first location on display */
+void lcd_clear()
+{
+	memset(lcd_fb, ' ', sizeof(lcd_fb));
+	LCDx = 0; LCDy = 0;
+}
+
+/* Character at the cursor, which moves right */
+void lcd_send(const uint8_t byte)
+{
+	if (LCDx < LCD_COLS && LCDy < LCD_ROWS)
+		lcd_fb[LCDy][LCDx] = byte;
+	LCDx++;
+}
+
+void lcd_display(uint8_t status)
+{
+}
+
+void lcd_print(const char *string)
+{
+	const char *ch;
+	for (ch = string; *ch; ch++)
+	{
+		if (*ch == '\n') {
+			if (LCDy == 0) {
+				LCDy = 1;
+				LCDx = 0;
+			}
+		} else {
+			if ((LCDx == 8) && (LCDy == 1)) break;
+			lcd_send(*ch);
+		}
+	}
+}
+
+static inline void lcd_chars()
+{
+	unsigned char byte, i, y;
+
+	hd.rs = 0;
+	lcd_write(0x40 + 8);
+	hd.rs = 1;
+
+	/* Same bitmaps as LCD.c */
+	byte = (1<<4);
+	for (i=0; i<5; i++) {
+		for (y=0; y<8; y++)
+			lcd_write(byte);
+		byte >>= 1;
+	}
+	byte = (1<<4);
+	for (y=0; y<8; y++) {
+		lcd_write(byte);
+		byte ^= (1<<3);
+	}
+	byte = 1;
+	for (y=0; y<8; y++) {
+		lcd_write(byte);
+		byte ^= (1<<1);
+	}
+
+	hd.rs = 0;
+	lcd_write(0x80);
+	hd.rs = 1;
+}
+
+static char lcd_glyph(const uint8_t c)
+{
+	static const char custom[] = " 12345[]";
+	int y;
+
+	if (c >= 8)
+		return c < 0x80 ? c : '#';
+
+	for (y = 0; y < 8; y++)
+		if (hd.cgram[c * 8 + y])
+			return custom[c];
+	return '?';
+}
+
+/* Screen is complete - send the cells that changed like LCD.c does,
+ * print the display if it changed */
+static void lcd_flush(void)
+{
+	char now[LCD_ROWS][LCD_COLS + 1];
+	int x, y;
+
+	for (y = 0; y < LCD_ROWS; y++) {
+		for (x = 0; x < LCD_COLS; x++) {
+			if (lcd_fb[y][x] == lcd_shown[y][x])
+				continue;
+			hd.rs = 0;
+			lcd_write(0x80 | (y * 64 + x));
+			hd.rs = 1;
+			lcd_write(lcd_fb[y][x]);
+			lcd_shown[y][x] = lcd_fb[y][x];
+		}
+	}
+
+	for (y = 0; y < LCD_ROWS; y++) {
+		for (x = 0; x < LCD_COLS; x++)
+			now[y][x] = lcd_glyph(hd.ddram[y * 64 + x]);
+		now[y][LCD_COLS] = '\0';
+	}
+	if (!memcmp(now, hd.shown, sizeof(now)))
+		return;
+	memcpy(hd.shown, now, sizeof(now));
+
+	fprintf(stdout, "%10.3f |%s|%s|\n", host_time(), now[0], now[1]);
+}
+
+/* Nothing is ever queued */
+static inline void lcd_drain(void)
+{
+}
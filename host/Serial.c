@@ -0,0 +1,31 @@
+/***********************************
+ * avr_tuner - host debug stream
+ * License: GPL3+ (See LICENSE)
+ *
+ * Debug output simply goes to the process stdout, serial_blocks()
+ * into the file given with -t (see host/Board.c), all at once.
+ ********************/
+
+struct serial_block {
+	const uint8_t *p;
+	uint16_t len;
+};
+
+#ifdef TELEMETRY
+static inline uint8_t serial_sending(void)
+{
+	return 0;
+}
+
+static inline void serial_blocks(struct serial_block *blk, const uint8_t n)
+{
+	uint8_t i;
+
+	for (i = 0; i < n && host.telemetry; i++)
+		fwrite(blk[i].p, 1, blk[i].len, host.telemetry);
+}
+#endif
+
+static inline void serial_init(void)
+{
+}
@@ -0,0 +1,9 @@
+/* Host build: the HD44780 model needs no timing, time only passes
+ * as samples are consumed. */
+
+#define msleep(x)
+#define usleep(x)
+
+void sleep(char count)
+{
+}
@@ -0,0 +1,165 @@
+/*
+ * Decoder of the tuner's telemetry frames (Telemetry.c).
+ *
+ *   teldecode [-s] [file]
+ *
+ * Reads the UART stream (a file, a serial device or stdin) and prints
+ * one line per frame: id, note, exponent, frequency found and the
+ * harmonics behind it (bar, Hz, level); -s adds the band of levels as
+ * analysed. Anything outside a frame (DEBUG printf text) is passed
+ * through. Frames failing their check and gaps in the ids are counted
+ * and summed up on stderr at the end.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Num.h"
+
+#define SYNC0	0xA5
+#define SYNC1	0x5A
+#define HEAD	10
+#define BAND_MAX 1024
+#define HARM_MAX 8
+
+static uint8_t buf[HEAD + 2 * BAND_MAX + 1 + 8 * HARM_MAX + 4 + 2];
+static size_t len;
+
+static int show_band;
+static long frames, bad, lost;
+static int last_id = -1;
+
+static unsigned le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static int32_t le32(const uint8_t *p)
+{
+	return (int32_t)(le16(p) | (uint32_t)le16(p + 2) << 16);
+}
+
+/* Bytes a frame starting at buf takes, 0 while more are needed, -1 if
+ * it can't be one */
+static long frame_len(void)
+{
+	unsigned count, n;
+
+	if (len < HEAD)
+		return 0;
+	count = le16(buf + 8);
+	if (count > BAND_MAX)
+		return -1;
+	if (len < HEAD + 2 * count + 1)
+		return 0;
+	n = buf[HEAD + 2 * count];
+	if (n > HARM_MAX)
+		return -1;
+	return HEAD + 2 * count + 1 + 8 * n + 4 + 2;
+}
+
+static int frame_ok(const long total)
+{
+	uint8_t a = 0, b = 0;
+	long i;
+
+	for (i = 2; i < total - 2; i++) {
+		a += buf[i];
+		b += a;
+	}
+	return a == buf[total - 2] && b == buf[total - 1];
+}
+
+static void frame_print(void)
+{
+	const unsigned id = buf[2], first = le16(buf + 6), count = le16(buf + 8);
+	const uint8_t *p = buf + HEAD + 2 * count;
+	const unsigned n = *p++;
+	unsigned i;
+
+	if (last_id >= 0 && id != ((last_id + 1) & 0xFF))
+		lost += (id - last_id - 1) & 0xFF;
+	last_id = id;
+	frames++;
+
+	printf("%3u note %u exp %2u", id, buf[3], buf[4]);
+	if (buf[5] & 1)
+		printf(" %8.3f Hz", le32(p + 8 * n) / (double)NUM_ONE);
+	else
+		printf("        - Hz");
+	for (i = 0; i < n; i++, p += 8)
+		printf("  %u:%.3f:%u", le16(p), le32(p + 2) / (double)NUM_ONE, le16(p + 6));
+	putchar('\n');
+
+	if (show_band && count) {
+		printf("    band %u:", first);
+		for (i = 0; i < count; i++)
+			printf(" %u", le16(buf + HEAD + 2 * i));
+		putchar('\n');
+	}
+}
+
+static void consume(const size_t n)
+{
+	memmove(buf, buf + n, len - n);
+	len -= n;
+}
+
+/* Decodes what's in buf, keeps an incomplete frame for later */
+static void decode(void)
+{
+	long total;
+
+	while (len) {
+		if (buf[0] != SYNC0 || (len > 1 && buf[1] != SYNC1)) {
+			putchar(buf[0]);
+			consume(1);
+			continue;
+		}
+		total = frame_len();
+		if (total == 0 || (total > 0 && (size_t)total > len))
+			return;
+		if (total < 0 || !frame_ok(total)) {
+			bad++;
+			consume(1);
+			continue;
+		}
+		frame_print();
+		consume(total);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int i, fd = 0;
+	ssize_t got;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-s"))
+			show_band = 1;
+		else
+			break;
+	}
+	if (i < argc - 1 || (i < argc && argv[i][0] == '-')) {
+		fprintf(stderr, "Usage: %s [-s] [file]\n", argv[0]);
+		return 2;
+	}
+	if (i < argc && (fd = open(argv[i], O_RDONLY)) < 0) {
+		perror(argv[i]);
+		return 1;
+	}
+
+	while ((got = read(fd, buf + len, sizeof(buf) - len)) > 0) {
+		len += got;
+		decode();
+		fflush(stdout);
+	}
+
+	fprintf(stderr, "%ld frames, %ld failed their check, %ld lost\n",
+		frames, bad, lost);
+	return 0;
+}
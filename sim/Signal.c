@@ -0,0 +1,78 @@
+/*
+ * Test signals for the simulator drivers.
+ */
+
+/* Sample rates of notes[] in Tuner.c put each note on bar FFT_N/4 */
+static const double note_hz[] = { 82.407, 110.0, 146.832, 195.998, 246.942, 329.628 };
+
+/* Small deterministic generator, so failures can be reproduced */
+static uint32_t seed = 12345;
+static uint16_t rnd(void)
+{
+	seed = seed * 1103515245UL + 12345;
+	return seed >> 16;
+}
+
+static double frnd(void)
+{
+	return rnd() / 65536.0;
+}
+
+/* One frame of a plucked string around the given note, at the note's
+ * sample rate, scaled like the ADC interrupt and the frame's block shift
+ * leave it (up to ~ +-32000). Returns the string's frequency. */
+static double gen_guitar(int16_t *src, const int note)
+{
+	const double rate = 4 * note_hz[note];
+	const double f = note_hz[note] * (0.97 + 0.06 * frnd());
+	const double decay = 0.5 + 3 * frnd();
+	const double gain = 2000 + 30000 * frnd();
+	double amp[6], phase[6], norm = 0;
+	int h, i;
+
+	for (h = 0; h < 6; h++) {
+		amp[h] = frnd() / (h + 1);
+		phase[h] = 2 * M_PI * frnd();
+		norm += amp[h];
+	}
+
+	for (i = 0; i < FFT_N; i++) {
+		const double t = i / rate;
+		double s = 0;
+		for (h = 0; h < 6; h++)
+			s += amp[h] * sin(2 * M_PI * f * (h + 1) * t + phase[h]);
+		s = s / norm * exp(-t / decay) * gain;
+		s += (frnd() - 0.5) * 64;
+		if (s > 32767)
+			s = 32767;
+		if (s < -32768)
+			s = -32768;
+		src[i] = (int16_t)s;
+	}
+	return f;
+}
+
+/* Like gen_guitar() with only the fundamental, which is all the CIC
+ * decimator leaves at the note's sample rate (the odd harmonics would
+ * alias onto it). Returns the tone's frequency. */
+static double gen_tone(int16_t *src, const int note)
+{
+	const double rate = 4 * note_hz[note];
+	const double f = note_hz[note] * (0.97 + 0.06 * frnd());
+	const double decay = 0.5 + 3 * frnd();
+	const double gain = 2000 + 30000 * frnd();
+	const double phase = 2 * M_PI * frnd();
+	int i;
+
+	for (i = 0; i < FFT_N; i++) {
+		const double t = i / rate;
+		double s = sin(2 * M_PI * f * t + phase) * exp(-t / decay) * gain;
+		s += (frnd() - 0.5) * 64;
+		if (s > 32767)
+			s = 32767;
+		if (s < -32768)
+			s = -32768;
+		src[i] = (int16_t)s;
+	}
+	return f;
+}
@@ -0,0 +1,78 @@
+/*
+ * simavr glue shared by the host drivers in this directory.
+ *
+ * The firmware under test exposes a mailbox `SIM_IO io' (struct fftio or
+ * struct benchio) starting with the ready and cmd bytes; its data address
+ * is taken from avr-nm by the Makefile and given on the command line.
+ * Everything else goes through sim_call().
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sim_avr.h>
+#include <sim_elf.h>
+
+static avr_t *avr;
+static uint16_t io_addr;
+
+/* Lowest stack pointer seen since the last sim_call() started */
+static uint16_t sim_sp_min;
+
+#define io_ptr(field) ((void *)(avr->data + io_addr + offsetof(SIM_IO, field)))
+
+static inline uint16_t sim_sp(void)
+{
+	return avr->data[R_SPL] | (avr->data[R_SPH] << 8);
+}
+
+static void sim_die(const char *what)
+{
+	fprintf(stderr, "sim: %s (pc=0x%04x cycle=%llu)\n", what,
+		avr ? avr->pc : 0, avr ? (unsigned long long)avr->cycle : 0ULL);
+	exit(2);
+}
+
+/* Runs one instruction, dies if the firmware stopped */
+static inline void sim_step(void)
+{
+	const int state = avr_run(avr);
+	if (state == cpu_Done || state == cpu_Crashed)
+		sim_die("firmware stopped");
+	if (sim_sp() < sim_sp_min)
+		sim_sp_min = sim_sp();
+}
+
+static void sim_load(const char *elf, const char *mcu, const char *addr)
+{
+	static elf_firmware_t fw;
+
+	if (elf_read_firmware(elf, &fw))
+		sim_die("cannot read firmware");
+	avr = avr_make_mcu_by_name(mcu);
+	if (!avr)
+		sim_die("unknown mcu");
+	avr_init(avr);
+	avr->frequency = 16000000;
+	avr_load_firmware(avr, &fw);
+
+	io_addr = strtoul(addr, NULL, 16) & 0xFFFF;
+
+	/* Let crt0 clear .bss before anything is written into the mailbox */
+	while (!*(volatile uint8_t *)io_ptr(ready))
+		sim_step();
+}
+
+/* Executes a mailbox command (0 is idle); returns the number of cycles
+ * it took, sim_sp_min tells how deep the stack went meanwhile */
+static uint64_t sim_call(const uint8_t cmd)
+{
+	volatile uint8_t *c = io_ptr(cmd);
+	const uint64_t start = avr->cycle;
+
+	sim_sp_min = sim_sp();
+	*c = cmd;
+	while (*c != 0)
+		sim_step();
+	return avr->cycle - start;
+}
@@ -0,0 +1,174 @@
+/*
+ * Cycle counts of the tuner stages on the simulated ATmega core.
+ *
+ *   bench [-m mcu] [-f frames] [-s static_sram] [-y yin_static_sram]
+ *         firmware.elf io_address
+ *
+ * Runs synthetic plucked strings of every note through fft_input,
+ * goertzel_spectrum (the alternative to the next two), fft_execute,
+ * fft_output, estimate_bar, spectrum_analyse and lcd_update, and
+ * through yin_input and yin_pitch (PITCH_YIN's replacement for all of
+ * them but lcd_update) inside bench_avr.c, and decaying clean tones
+ * through each peak estimator of Peak.c, and prints one tab separated
+ * line per stage:
+ *
+ *   fft_n stage calls min mean max us stack sram cents
+ *
+ * Cycles exclude the mailbox overhead; us is the mean at 16 MHz; stack
+ * is the deepest stack use in bytes below the firmware's main loop;
+ * sram is static_sram (data+bss of the real tuner image, from -s; -y
+ * for the PITCH_YIN image and the yin stages) plus that stack. cents
+ * is the mean error of a peak estimator against the tone's true
+ * frequency ("-" for the other stages).
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include "../FFT/ffft.h"
+#include "../Num.h"
+#include "benchio.h"
+
+#define SIM_IO struct benchio
+#include "Sim.c"
+#include "Signal.c"
+
+static const char *names[BENCH_CMDS] = {
+	[BENCH_INPUT] = "fft_input",
+	[BENCH_EXECUTE] = "fft_execute",
+	[BENCH_OUTPUT] = "fft_output",
+	[BENCH_OUTPUT_BAND] = "fft_output_band",
+	[BENCH_GOERTZEL] = "goertzel_spectrum",
+	[BENCH_ESTIMATE] = "estimate_bar",
+	[BENCH_PEAK_CENTROID] = "peak_centroid",
+	[BENCH_PEAK_PARABOLIC] = "peak_parabolic",
+	[BENCH_PEAK_GAUSSIAN] = "peak_gaussian",
+	[BENCH_PEAK_JAIN] = "peak_jain",
+	[BENCH_ANALYSE] = "spectrum_analyse",
+	[BENCH_LCD] = "lcd_update",
+	[BENCH_YIN_INPUT] = "yin_input",
+	[BENCH_YIN] = "yin_pitch",
+};
+
+static struct {
+	unsigned calls;
+	uint64_t min, max, sum;
+	unsigned stack;
+	double cents;
+} stat[BENCH_CMDS];
+
+static uint64_t overhead;
+
+/* Stack pointer inside the idle mailbox loop */
+static uint16_t io_sp_base;
+
+static void run(const uint8_t cmd)
+{
+	const uint64_t c = sim_call(cmd) - overhead;
+	const unsigned stack = io_sp_base - sim_sp_min;
+
+	if (!stat[cmd].calls || c < stat[cmd].min)
+		stat[cmd].min = c;
+	if (c > stat[cmd].max)
+		stat[cmd].max = c;
+	if (stack > stat[cmd].stack)
+		stat[cmd].stack = stack;
+	stat[cmd].sum += c;
+	stat[cmd].calls++;
+}
+
+/* Runs a peak estimator on the bar BENCH_PEAK found; the string is at
+ * bar 'exact' */
+static void run_peak(const uint8_t cmd, const double exact)
+{
+	int16_t bar, offset;
+
+	run(cmd);
+	memcpy(&bar, io_ptr(bar), 2);
+	memcpy(&offset, io_ptr(offset), 2);
+	stat[cmd].cents += fabs(1200 * log2((bar + offset / (double)NUM_ONE) / exact));
+}
+
+int main(int argc, char *argv[])
+{
+	const char *mcu = "atmega32";
+	unsigned sram = 0, sram_yin = 0;
+	int16_t src[FFT_N];
+	int frames = 10;
+	int i, note, cmd;
+
+	for (i = 1; i < argc - 2 && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-m"))
+			mcu = argv[++i];
+		else if (!strcmp(argv[i], "-f"))
+			frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-s"))
+			sram = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-y"))
+			sram_yin = atoi(argv[++i]);
+	}
+	if (i != argc - 2) {
+		fprintf(stderr, "Usage: %s [-m mcu] [-f frames] [-s static_sram] "
+			"[-y yin_static_sram] firmware.elf io_address\n", argv[0]);
+		return 2;
+	}
+	sim_load(argv[i], mcu, argv[i + 1]);
+
+	/* Mailbox polling and dispatch, the same for every command */
+	io_sp_base = sim_sp();
+	overhead = sim_call(BENCH_NOP);
+
+	for (note = 0; note < 6; note++) {
+		*(uint8_t *)io_ptr(note) = note;
+		for (i = 0; i < frames; i++) {
+			gen_guitar(src, note);
+			memcpy(io_ptr(src), src, sizeof(src));
+
+			run(BENCH_INPUT);
+			run(BENCH_GOERTZEL);
+			run(BENCH_EXECUTE);
+			run(BENCH_OUTPUT);
+			run(BENCH_OUTPUT_BAND);
+			sim_call(BENCH_PEAK);
+			run(BENCH_ESTIMATE);
+			run(BENCH_ANALYSE);
+			run(BENCH_LCD);
+
+			/* Last, the frame overwrites fft_buff */
+			run(BENCH_YIN_INPUT);
+			run(BENCH_YIN);
+		}
+
+		/* Peak estimators on clean tones, 10 times as many frames */
+		for (i = 0; i < 10 * frames; i++) {
+			const double f = gen_tone(src, note);
+
+			memcpy(io_ptr(src), src, sizeof(src));
+			sim_call(BENCH_INPUT);
+			sim_call(BENCH_EXECUTE);
+			sim_call(BENCH_OUTPUT);
+			sim_call(BENCH_PEAK);
+			for (cmd = BENCH_PEAK_CENTROID; cmd <= BENCH_PEAK_JAIN; cmd++)
+				run_peak(cmd, FFT_N / 4 * f / note_hz[note]);
+		}
+	}
+
+	printf("# fft_n\tstage\tcalls\tmin\tmean\tmax\tus\tstack\tsram\tcents\n");
+	for (cmd = 0; cmd < BENCH_CMDS; cmd++) {
+		if (!names[cmd])
+			continue;
+		const double mean = (double)stat[cmd].sum / stat[cmd].calls;
+		const unsigned base = cmd >= BENCH_YIN_INPUT ? sram_yin : sram;
+		printf("%d\t%s\t%u\t%llu\t%.0f\t%llu\t%.1f\t%u\t%u\t",
+		       FFT_N, names[cmd], stat[cmd].calls,
+		       (unsigned long long)stat[cmd].min, mean,
+		       (unsigned long long)stat[cmd].max,
+		       mean / 16.0, stat[cmd].stack, base + stat[cmd].stack);
+		if (cmd >= BENCH_PEAK_CENTROID && cmd <= BENCH_PEAK_JAIN)
+			printf("%.2f\n", stat[cmd].cents / stat[cmd].calls);
+		else
+			printf("-\n");
+	}
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Firmware for the stage benchmark (see bench.c): the tuner's analysis
+ * code from Tuner.c, every peak estimator of Peak.c, the Goertzel and
+ * YIN engines plus the real LCD driver, built like Main.c.
+ */
+#define F_CPU 16000000UL
+#define inline
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "../Config.h"
+#include "../HAL.h"
+#include "../Num.h"
+
+#define printf(x, ...)
+
+#include "../Sleep.c"
+#include "../LCD.c"
+
+#define PEAK_ALL
+#include "../Peak.c"
+#include "../Tuner.c"
+#include "../Goertzel.c"
+#include "../Yin.c"
+#include "benchio.h"
+
+struct benchio io;
+
+/* Keeps results of pure functions alive */
+volatile num_t bench_sink;
+
+int main(void)
+{
+	int i;
+
+	lcd_init();
+	lcd_chars();
+
+	io.ready = 1;
+	for (;;) {
+		const uint8_t cmd = io.cmd;
+
+		/* Arguments were written before cmd */
+		__asm__ __volatile__ ("" ::: "memory");
+		current_note = io.note;
+
+		switch (cmd) {
+		case BENCH_NOP:
+			break;
+		case BENCH_INPUT:
+			/* src is at full scale already */
+			spectrum_exp = 0;
+			fft_input(io.src, v.fft_buff, 0);
+			break;
+		case BENCH_GOERTZEL:
+			goertzel_spectrum();
+			break;
+		case BENCH_EXECUTE:
+			spectrum_exp += fft_execute(v.fft_buff);
+			break;
+		case BENCH_OUTPUT:
+			fft_output(v.fft_buff, spectrum);
+			break;
+		case BENCH_OUTPUT_BAND:
+			fft_output_band(v.fft_buff, spectrum, SPECTRUM_FIRST, SPECTRUM_COUNT);
+			break;
+		case BENCH_PEAK:
+			io.bar = spectrum_min + 4;
+			for (i = spectrum_min + 4; i < spectrum_max - 4; i++)
+				if (spectrum[i] > spectrum[io.bar])
+					io.bar = i;
+			break;
+		case BENCH_ESTIMATE:
+			bench_sink = estimate_bar(io.bar);
+			break;
+		case BENCH_PEAK_CENTROID:
+			io.offset = peak_centroid(&spectrum[io.bar]);
+			break;
+		case BENCH_PEAK_PARABOLIC:
+			io.offset = peak_parabolic(&spectrum[io.bar]);
+			break;
+		case BENCH_PEAK_GAUSSIAN:
+			io.offset = peak_gaussian(&spectrum[io.bar]);
+			break;
+		case BENCH_PEAK_JAIN:
+			io.offset = peak_jain(&spectrum[io.bar]);
+			break;
+		case BENCH_ANALYSE:
+			spectrum_analyse();
+			break;
+		case BENCH_LCD:
+			/* Every cell changed, nothing queued: the most
+			 * lcd_flush() ever does */
+			memset(lcd_shown, 0, sizeof(lcd_shown));
+			lcd_queue_tail = lcd_queue_head;
+			tick = 3000;
+			lcd_update();
+			break;
+		case BENCH_YIN_INPUT:
+			yin_input(io.src, 0, 0);
+			break;
+		case BENCH_YIN:
+			bench_sink = yin_pitch();
+			break;
+		default:
+			continue;
+		}
+
+		__asm__ __volatile__ ("" ::: "memory");
+		io.cmd = BENCH_IDLE;
+	}
+}
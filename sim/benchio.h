@@ -0,0 +1,38 @@
+/*
+ * Mailbox of the stage benchmark (bench_avr.c <-> bench.c), see fftio.h.
+ * The FFT buffers are the tuner's own v.fft_buff and spectrum[].
+ */
+#ifndef _BENCHIO_H_
+#define _BENCHIO_H_
+
+enum {
+	BENCH_IDLE = 0,
+	BENCH_NOP,		/* Mailbox overhead, subtracted from the rest */
+	BENCH_INPUT,		/* fft_input(src, v.fft_buff, 0) */
+	BENCH_EXECUTE,		/* spectrum_exp += fft_execute(v.fft_buff) */
+	BENCH_OUTPUT,		/* fft_output(v.fft_buff, spectrum) */
+	BENCH_OUTPUT_BAND,	/* fft_output_band() of the analysed bars */
+	BENCH_GOERTZEL,		/* goertzel_spectrum() on fft_input's frame */
+	BENCH_PEAK,		/* bar = highest spectrum bin (not reported) */
+	BENCH_ESTIMATE,		/* estimate_bar(bar) */
+	BENCH_PEAK_CENTROID,	/* offset = peak_centroid(&spectrum[bar]) */
+	BENCH_PEAK_PARABOLIC,	/* ... peak_parabolic */
+	BENCH_PEAK_GAUSSIAN,	/* ... peak_gaussian */
+	BENCH_PEAK_JAIN,	/* ... peak_jain */
+	BENCH_ANALYSE,		/* spectrum_analyse() */
+	BENCH_LCD,		/* lcd_update() of a full screen */
+	BENCH_YIN_INPUT,	/* yin_input(src, 0, 0) */
+	BENCH_YIN,		/* yin_pitch() */
+	BENCH_CMDS
+};
+
+struct benchio {
+	volatile uint8_t ready;
+	volatile uint8_t cmd;
+	uint8_t note;
+	int16_t bar;
+	int16_t offset;		/* num_t */
+	int16_t src[FFT_N];
+} __attribute__((packed));
+
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Cross-validation of FFT/ffft.c against FFT/ffft.S running in simavr.
+ *
+ *   fftcheck [-m mcu] [-v vectors] firmware.elf io_address
+ *
+ * Both sides get the same data for every stage (fft_input, fft_input_ring,
+ * fft_execute, fft_output, fft_output_band, fmuls_f) and must agree bit
+ * for bit, fft_execute's count of unscaled stages included. Input sets:
+ *   random  - uniform full-scale samples through all three stages
+ *   guitar  - decaying plucked strings (every other pair of vectors a
+ *             clean tone) at each note's sample rate, scaled like the
+ *             ADC interrupt does (up to ~ +-32000), then brought down
+ *             and shifted back up by fft_input
+ *   bfly    - uniform complex data straight into fft_execute, full-scale
+ *             or small enough to leave stages unscaled
+ *   edge    - parts of -32768 or 32767 (every other vector mixed with
+ *             random ones) straight into the outputs, which have to
+ *             saturate
+ *
+ * Run once per INPUT_REAL setting; both are checked by 'make fftcheck'.
+ *
+ * Exit status is 0 when everything matched, 1 on the first mismatch.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include "../FFT/ffft.h"
+#include "fftio.h"
+
+#if INPUT_REAL
+#define MODE "real"
+#else
+#define MODE "r=i"
+#endif
+
+#define SIM_IO struct fftio
+#include "Sim.c"
+#include "Signal.c"
+
+static int16_t src[FFT_N];
+static complex_t bfly[FFT_BFLY];
+static uint16_t out[FFT_N / 2];
+
+static int compare(const char *set, int vec, const char *stage,
+		   const void *avr_data, const void *ref, int words)
+{
+	const int16_t *a = avr_data, *r = ref;
+	int i;
+
+	for (i = 0; i < words; i++) {
+		if (a[i] != r[i]) {
+			printf("FFT_N=%d " MODE " %s #%d %s: word %d avr=%d ref=%d\n",
+			       FFT_N, set, vec, stage, i, a[i], r[i]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Runs both outputs on bfly (already in the mailbox too); every other
+ * vector the band is a random part of the spectrum */
+static int check_output(const char *set, int vec)
+{
+	uint16_t first = 0, count = FFT_N / 2;
+
+	sim_call(IO_OUTPUT);
+	fft_output(bfly, out);
+	if (compare(set, vec, "fft_output", io_ptr(out), out, FFT_N / 2))
+		return 1;
+
+	if (vec & 1) {
+		first = rnd() % (FFT_N / 2);
+		count = 1 + rnd() % (FFT_N / 2 - first);
+	}
+	memcpy(io_ptr(first), &first, 2);
+	memcpy(io_ptr(count), &count, 2);
+	sim_call(IO_OUTPUT_BAND);
+	fft_output_band(bfly, out, first, count);
+	return compare(set, vec, "fft_output_band", io_ptr(out), out, FFT_N / 2);
+}
+
+/* Runs execute + both outputs on bfly (already in the mailbox too) */
+static int check_tail(const char *set, int vec)
+{
+	uint8_t unscaled;
+
+	sim_call(IO_EXECUTE);
+	unscaled = fft_execute(bfly);
+	if (compare(set, vec, "fft_execute", io_ptr(bfly), bfly, FFT_BFLY * 2))
+		return 1;
+	if (*(uint8_t *)io_ptr(unscaled) != unscaled) {
+		printf("FFT_N=%d " MODE " %s #%d fft_execute: unscaled avr=%d ref=%d\n",
+		       FFT_N, set, vec, *(uint8_t *)io_ptr(unscaled), unscaled);
+		return 1;
+	}
+	return check_output(set, vec);
+}
+
+/* Every other vector goes in through fft_input_ring at a random start */
+static int check_src(const char *set, int vec, const uint8_t shift)
+{
+	const uint16_t start = rnd() % FFT_N;
+
+	memcpy(io_ptr(src), src, sizeof(src));
+	memcpy(io_ptr(shift), &shift, 1);
+	if (vec & 1) {
+		memcpy(io_ptr(first), &start, 2);
+		sim_call(IO_INPUT_RING);
+		fft_input_ring(src, start, bfly, shift);
+		if (compare(set, vec, "fft_input_ring", io_ptr(bfly), bfly, FFT_BFLY * 2))
+			return 1;
+	} else {
+		sim_call(IO_INPUT);
+		fft_input(src, bfly, shift);
+		if (compare(set, vec, "fft_input", io_ptr(bfly), bfly, FFT_BFLY * 2))
+			return 1;
+	}
+	return check_tail(set, vec);
+}
+
+static void gen_random(void)
+{
+	int i;
+	for (i = 0; i < FFT_N; i++)
+		src[i] = rnd();
+}
+
+static int check_fmuls(void)
+{
+	static const int16_t edge[] = {
+		-32768, -32767, -257, -256, -129, -128, -1, 0,
+		1, 127, 128, 255, 256, 32766, 32767,
+	};
+	const int ne = sizeof(edge) / sizeof(*edge);
+	int i;
+
+	for (i = 0; i < ne * ne + 5000; i++) {
+		const int16_t a = i < ne * ne ? edge[i / ne] : (int16_t)rnd();
+		const int16_t b = i < ne * ne ? edge[i % ne] : (int16_t)rnd();
+		const int16_t r = fmuls_f(a, b);
+
+		memcpy(io_ptr(a), &a, 2);
+		memcpy(io_ptr(b), &b, 2);
+		sim_call(IO_FMULS);
+		if (compare("fmuls", i, "fmuls_f", io_ptr(r), &r, 1))
+			return 1;
+	}
+	printf("FFT_N=%d " MODE " fmuls_f: %d pairs ok\n", FFT_N, i);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *mcu = "atmega32";
+	int vectors = 200;
+	int i, v;
+
+	for (i = 1; i < argc - 2 && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-m"))
+			mcu = argv[++i];
+		else if (!strcmp(argv[i], "-v"))
+			vectors = atoi(argv[++i]);
+	}
+	if (i != argc - 2) {
+		fprintf(stderr, "Usage: %s [-m mcu] [-v vectors] firmware.elf io_address\n", argv[0]);
+		return 2;
+	}
+	sim_load(argv[i], mcu, argv[i + 1]);
+
+	if (check_fmuls())
+		return 1;
+
+	for (v = 0; v < vectors; v++) {
+		gen_random();
+		if (check_src("random", v, 0))
+			return 1;
+	}
+	printf("FFT_N=%d " MODE " random: %d vectors ok\n", FFT_N, vectors);
+
+	for (v = 0; v < vectors; v++) {
+		const uint8_t shift = v % 8;
+
+		if (v & 2)
+			gen_tone(src, v % 6);
+		else
+			gen_guitar(src, v % 6);
+		for (i = 0; i < FFT_N; i++)
+			src[i] >>= shift;
+		if (check_src("guitar", v, shift))
+			return 1;
+	}
+	printf("FFT_N=%d " MODE " guitar: %d vectors ok\n", FFT_N, vectors);
+
+	for (v = 0; v < vectors; v++) {
+		for (i = 0; i < FFT_BFLY; i++) {
+			bfly[i].r = (int16_t)rnd() >> (v & 3) * 2;
+			bfly[i].i = (int16_t)rnd() >> (v & 3) * 2;
+		}
+		memcpy(io_ptr(bfly), bfly, sizeof(bfly));
+		if (check_tail("bfly", v))
+			return 1;
+	}
+	printf("FFT_N=%d " MODE " bfly: %d vectors ok\n", FFT_N, vectors);
+
+	for (v = 0; v < vectors; v++) {
+		int16_t *p = (int16_t *)bfly;
+
+		for (i = 0; i < FFT_BFLY * 2; i++) {
+			const uint16_t x = rnd();
+
+			p[i] = (v & 1) && (x & 2) ? (int16_t)rnd() : x & 1 ? 32767 : -32768;
+		}
+		memcpy(io_ptr(bfly), bfly, sizeof(bfly));
+		if (check_output("edge", v))
+			return 1;
+	}
+	printf("FFT_N=%d " MODE " edge: %d vectors ok\n", FFT_N, vectors);
+
+	return 0;
+}
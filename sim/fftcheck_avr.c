@@ -0,0 +1,46 @@
+/*
+ * Firmware for the ffft.S cross-validation (see fftcheck.c).
+ * Runs single FFT stages on the data the host puts into the mailbox.
+ */
+#include <inttypes.h>
+#include "../FFT/ffft.h"
+#include "fftio.h"
+
+struct fftio io;
+
+int main(void)
+{
+	io.ready = 1;
+	for (;;) {
+		const uint8_t cmd = io.cmd;
+
+		/* Arguments were written before cmd */
+		__asm__ __volatile__ ("" ::: "memory");
+
+		switch (cmd) {
+		case IO_INPUT:
+			fft_input(io.src, io.bfly, io.shift);
+			break;
+		case IO_INPUT_RING:
+			fft_input_ring(io.src, io.first, io.bfly, io.shift);
+			break;
+		case IO_EXECUTE:
+			io.unscaled = fft_execute(io.bfly);
+			break;
+		case IO_OUTPUT:
+			fft_output(io.bfly, io.out);
+			break;
+		case IO_OUTPUT_BAND:
+			fft_output_band(io.bfly, io.out, io.first, io.count);
+			break;
+		case IO_FMULS:
+			io.r = fmuls_f(io.a, io.b);
+			break;
+		default:
+			continue;
+		}
+
+		__asm__ __volatile__ ("" ::: "memory");
+		io.cmd = IO_IDLE;
+	}
+}
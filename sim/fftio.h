@@ -0,0 +1,37 @@
+/*
+ * Mailbox between the simulated firmware (fftcheck_avr.c, bench_avr.c)
+ * and the host driver talking to simavr. The host finds `io' in the
+ * firmware symbol table, writes arguments into it, sets cmd and runs
+ * the simulation until the firmware clears cmd again.
+ *
+ * Packed so the layout is the same on the AVR and on the host.
+ */
+#ifndef _FFTIO_H_
+#define _FFTIO_H_
+
+#ifdef INPUT_IQ
+#error Cross-validation covers the real-input (non INPUT_IQ) builds only.
+#endif
+
+enum {
+	IO_IDLE = 0,
+	IO_INPUT,	/* fft_input(src, bfly, shift) */
+	IO_INPUT_RING,	/* fft_input_ring(src, first, bfly, shift) */
+	IO_EXECUTE,	/* unscaled = fft_execute(bfly) */
+	IO_OUTPUT,	/* fft_output(bfly, out) */
+	IO_OUTPUT_BAND,	/* fft_output_band(bfly, out, first, count) */
+	IO_FMULS,	/* r = fmuls_f(a, b) */
+};
+
+struct fftio {
+	volatile uint8_t ready;	/* Set once firmware got through startup */
+	volatile uint8_t cmd;
+	int16_t a, b, r;
+	uint8_t shift, unscaled;
+	uint16_t first, count;	/* Band, or ring start for IO_INPUT_RING */
+	int16_t src[FFT_N];
+	complex_t bfly[FFT_BFLY];
+	uint16_t out[FFT_N / 2];
+} __attribute__((packed));
+
+#endif